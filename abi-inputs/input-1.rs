@@ -0,0 +1,64 @@
+struct V2 {
+    x: i64,
+    y: i64,
+}
+
+struct Rgb {
+    r: u8,
+    g: u8,
+    b: u8,
+    a: i32,
+}
+
+fn dot(a: V2, b: V2) -> i64 {
+    if (a.x < 0) {
+        return(dot(b, a));
+    }
+    return(a.x * b.x + a.y * b.y);
+}
+
+fn shade(c: Rgb, k: i64) -> i64 {
+    if (k < 0) {
+        return(shade(c, 0));
+    }
+    return(c.r as i64 + c.g as i64 * k + c.b as i64 + c.a as i64);
+}
+
+fn total(v: [i64; 64], n: i64) -> i64 {
+    if (n < 0) {
+        return(total(v, 0));
+    }
+    let s: i64 = 0;
+    let i: i64 = 0;
+    while (i < n) {
+        s = s + v[i];
+        i = i + 1;
+    }
+    return(s);
+}
+
+fn bump(v: [i64; 64], k: i64) -> i64 {
+    if (k < 0) {
+        return(bump(v, 0));
+    }
+    v[k] = v[k] + 1000;
+    return(v[k] + v[0]);
+}
+
+fn main() {
+    let p: V2 = V2 { x: 3, y: 4 };
+    let q: V2 = V2 { x: 5, y: 6 };
+    let c: Rgb = Rgb { r: 10, g: 20, b: 30, a: 0 - 7 };
+    let big: [i64; 64] = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64];
+    let s: i64 = 0;
+    let i: i64 = 0;
+    while (i < 100000) {
+        s = s + total(big, 64) + dot(p, q) + shade(c, 2);
+        big[i - i / 64 * 64] = big[i - i / 64 * 64] + 1;
+        i = i + 1;
+    }
+    println!("{}", s);
+    println!("{}", bump(big, 5));
+    println!("{}", big[5]);
+    println!("{}", dot(V2 { x: 1, y: 2 }, V2 { x: dot(p, q), y: 1 }) + total(big, 2));
+}
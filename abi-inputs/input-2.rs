@@ -0,0 +1,37 @@
+struct W {
+    k: i64,
+    v: [i64; 4],
+}
+
+static mut G: [i64; 4] = [1, 2, 3, 4];
+static mut S: W = W { k: 7, v: [5, 6, 7, 8] };
+
+fn f(a: [i64; 4]) -> i64 {
+    if (a[1] < 0) {
+        return(f(a));
+    }
+    G[0] = 100;
+    return(a[0]);
+}
+
+fn g(a: [i64; 4]) -> i64 {
+    S.v[0] = 200;
+    return(a[0] + a[1]);
+}
+
+fn h(w: W, n: i64) -> i64 {
+    if (n < 0) {
+        return(h(w, 0));
+    }
+    S.k = 9;
+    return(w.k + n);
+}
+
+fn main() {
+    println!("{}", f(G));
+    println!("{}", G[0]);
+    println!("{}", g(S.v));
+    println!("{}", h(S, 1));
+    println!("{}", S.k + S.v[0]);
+    return(0);
+}
@@ -56,6 +56,10 @@ int WhileStm::accept(Visitor* visitor) {
     return visitor->visit(this);
 }
 
+int MatchStm::accept(Visitor* visitor) {
+    return visitor->visit(this);
+}
+
 int Body::accept(Visitor* visitor){
     return visitor->visit(this);
 }
@@ -92,6 +96,10 @@ int StringExp::accept(Visitor* visitor){
     return visitor->visit(this);
 }
 
+int CastExp::accept(Visitor* visitor){
+    return visitor->visit(this);
+}
+
 int FcallStm::accept(Visitor* visitor){
     return visitor->visit(this);
 }
@@ -0,0 +1,18 @@
+fn main() {
+    let a: [i64; 7] = [0, 0, 0, 0, 0, 0, 0];
+    let b: [i64; 7] = [1, 2, 3, 4, 5, 6, 7];
+    let c: [i64; 7] = [0, 0, 0, 0, 0, 0, 0];
+    let i: i64 = 0;
+    while (i < 7) {
+        a[i] = b[i] + 5000000000;
+        i = i + 1;
+    }
+    let j: i64 = 0;
+    while (j < 7) {
+        c[j] = 6000000000 - b[j];
+        j = j + 1;
+    }
+    println!("{}", a[0] + a[6]);
+    println!("{}", c[1] + c[5]);
+    return(0);
+}
@@ -28,7 +28,7 @@ BinaryExp::~BinaryExp() {
 }
 
 // ------------------ NumberExp ------------------
-NumberExp::NumberExp(int v) : value(v) {}
+NumberExp::NumberExp(long long v) : value(v) {}
 
 NumberExp::~NumberExp() {}
 
@@ -56,6 +56,10 @@ IfStm::IfStm(Exp* c, Body* t, Body* e): condition(c), then(t), els(e) {}
 
 WhileStm::WhileStm(Exp* c, Body* t): condition(c), b(t) {}
 
+MatchArm::MatchArm(Body* b): body(b) {}
+
+MatchStm::MatchStm(Exp* s): scrutinee(s), otherwise(nullptr) {}
+
 PrintStm::PrintStm(Exp* expresion){
     e=expresion;
 }
@@ -93,4 +97,177 @@ Body::Body(){
 
 Body::~Body(){}
 
+string opImplName(const ImplDec* impl) {
+    string opName;
+    if      (impl->traitName == "Add") opName = "add";
+    else if (impl->traitName == "Sub") opName = "sub";
+    else if (impl->traitName == "Mul") opName = "mul";
+    else if (impl->traitName == "Div") opName = "div";
+    else return "";
+    return "__op_" + opName + "_" + impl->typeName + "_" + impl->paramType;
+}
+
+
+// ------------------ clonado ------------------
+
+Exp* cloneExp(Exp* e) {
+    if (!e) return nullptr;
+    Exp* c = nullptr;
+
+    if (auto n = dynamic_cast<NumberExp*>(e)) {
+        c = new NumberExp(n->value);
+    }
+    else if (auto id = dynamic_cast<IdExp*>(e)) {
+        c = new IdExp(id->value);
+    }
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        BinaryExp* nb = new BinaryExp(cloneExp(b->left), cloneExp(b->right), b->op);
+        nb->hasOverloadedImpl = b->hasOverloadedImpl;
+        nb->implFuncName      = b->implFuncName;
+        c = nb;
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        FcallExp* nf = new FcallExp();
+        nf->nombre = f->nombre;
+        for (auto a : f->argumentos) nf->argumentos.push_back(cloneExp(a));
+        c = nf;
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        c = new FieldAccessExp(cloneExp(fa->base), fa->field);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        StructLitExp* ns = new StructLitExp();
+        ns->nombre = sl->nombre;
+        for (auto &f : sl->fields) ns->fields.push_back({f.first, cloneExp(f.second)});
+        c = ns;
+    }
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        c = new IndexExp(cloneExp(ix->array), cloneExp(ix->index));
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        vector<Exp*> elems;
+        for (auto x : al->elems) elems.push_back(cloneExp(x));
+        c = new ArrayLitExp(elems);
+    }
+    else if (auto s = dynamic_cast<StringExp*>(e)) {
+        c = new StringExp(s->value);
+    }
+    else if (auto ce = dynamic_cast<CastExp*>(e)) {
+        c = new CastExp(cloneExp(ce->e), ce->type);
+    }
+
+    if (c) c->ty = e->ty;
+    return c;
+}
+
+Stm* cloneStm(Stm* s) {
+    if (!s) return nullptr;
+
+    if (auto let = dynamic_cast<LetStm*>(s)) {
+        return new LetStm(let->id, let->type, cloneExp(let->e), let->mut);
+    }
+    if (auto a = dynamic_cast<AssignStm*>(s)) {
+        return new AssignStm(cloneExp(a->lhs), cloneExp(a->e));
+    }
+    if (auto p = dynamic_cast<PrintStm*>(s)) {
+        return new PrintStm(cloneExp(p->e));
+    }
+    if (auto r = dynamic_cast<ReturnStm*>(s)) {
+        ReturnStm* nr = new ReturnStm();
+        nr->e = cloneExp(r->e);
+        return nr;
+    }
+    if (auto i = dynamic_cast<IfStm*>(s)) {
+        return new IfStm(cloneExp(i->condition), cloneBody(i->then), cloneBody(i->els));
+    }
+    if (auto w = dynamic_cast<WhileStm*>(s)) {
+        return new WhileStm(cloneExp(w->condition), cloneBody(w->b));
+    }
+    if (auto m = dynamic_cast<MatchStm*>(s)) {
+        MatchStm* nm = new MatchStm(cloneExp(m->scrutinee));
+        for (auto arm : m->arms) {
+            MatchArm* na = new MatchArm(cloneBody(arm->body));
+            na->ranges = arm->ranges;
+            nm->arms.push_back(na);
+        }
+        nm->otherwise = cloneBody(m->otherwise);
+        return nm;
+    }
+    if (auto fs = dynamic_cast<FcallStm*>(s)) {
+        return new FcallStm(static_cast<FcallExp*>(cloneExp(fs->call)));
+    }
+    return nullptr;
+}
+
+Body* cloneBody(Body* b) {
+    if (!b) return nullptr;
+    Body* nb = new Body();
+    for (auto v : b->vars)    nb->vars.push_back(static_cast<LetStm*>(cloneStm(v)));
+    for (auto s : b->StmList) nb->StmList.push_back(cloneStm(s));
+    return nb;
+}
+
+// ------------------ consultas ------------------
+
+// sin llamadas ni efectos: se puede evaluar una vez por campo y en otro orden
+bool isPure(Exp* e) {
+    if (dynamic_cast<NumberExp*>(e) || dynamic_cast<IdExp*>(e) || dynamic_cast<StringExp*>(e)) {
+        return true;
+    }
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        return !b->hasOverloadedImpl && isPure(b->left) && isPure(b->right);
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return isPure(fa->base);
+    if (auto ix = dynamic_cast<IndexExp*>(e))       return isPure(ix->array) && isPure(ix->index);
+    if (auto c = dynamic_cast<CastExp*>(e))         return isPure(c->e);
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) if (!isPure(f.second)) return false;
+        return true;
+    }
+    return false;
+}
 
+bool mentions(Exp* e, const string& name) {
+    if (!e) return false;
+    if (auto id = dynamic_cast<IdExp*>(e)) return id->value == name;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) return mentions(b->left, name) || mentions(b->right, name);
+    if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : f->argumentos) if (mentions(a, name)) return true;
+        return false;
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return mentions(fa->base, name);
+    if (auto ix = dynamic_cast<IndexExp*>(e)) return mentions(ix->array, name) || mentions(ix->index, name);
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) if (mentions(f.second, name)) return true;
+        return false;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) if (mentions(x, name)) return true;
+    }
+    if (auto c = dynamic_cast<CastExp*>(e)) return mentions(c->e, name);
+    return false;
+}
+
+static void countLets(Stm* s, unordered_map<string, int>& decls) {
+    if (auto i = dynamic_cast<IfStm*>(s)) {
+        countLets(i->then, decls);
+        countLets(i->els, decls);
+    }
+    else if (auto w = dynamic_cast<WhileStm*>(s)) countLets(w->b, decls);
+    else if (auto m = dynamic_cast<MatchStm*>(s)) {
+        for (auto arm : m->arms) countLets(arm->body, decls);
+        countLets(m->otherwise, decls);
+    }
+}
+
+void countLets(Body* b, unordered_map<string, int>& decls) {
+    if (!b) return;
+    for (auto v : b->vars) decls[v->id]++;
+    for (auto s : b->StmList) countLets(s, decls);
+}
+
+void collectLets(Body* b, unordered_set<string>& names) {
+    unordered_map<string, int> decls;
+    countLets(b, decls);
+    for (auto &d : decls) names.insert(d.first);
+}
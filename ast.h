@@ -5,6 +5,8 @@
 #include <list>
 #include <ostream>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
 using namespace std;
 
 class Visitor;
@@ -51,9 +53,9 @@ public:
 // Expresión numérica
 class NumberExp : public Exp {
 public:
-    int value;
+    long long value;
     int accept(Visitor* visitor);
-    NumberExp(int v);
+    NumberExp(long long v);
     ~NumberExp();
 };
 
@@ -145,6 +147,10 @@ struct ImplDec {
 
 };
 
+// Función que implementa el operador de un impl (__op_add_T_U), o "" si el trait no
+// es Add/Sub/Mul/Div. Único sitio con el nombre: typechecker, pasadas y generador.
+string opImplName(const ImplDec* impl);
+
 // ------------------ Stm -------------------
 
 class IfStm: public Stm {
@@ -166,6 +172,24 @@ public:
     ~WhileStm(){};
 };
 
+// brazo de un match: literales y rangos lo..=hi (un literal es lo == hi)
+class MatchArm {
+public:
+    vector<pair<long long,long long>> ranges;
+    Body* body;
+    MatchArm(Body* body);
+};
+
+class MatchStm: public Stm {
+public:
+    Exp* scrutinee;
+    vector<MatchArm*> arms;
+    Body* otherwise;            // brazo `_`, nullptr si no hay
+    MatchStm(Exp* scrutinee);
+    int accept(Visitor* visitor);
+    ~MatchStm(){};
+};
+
 class AssignStm: public Stm {
 public:
     Exp* lhs;
@@ -276,12 +300,31 @@ struct StringExp : public Exp {
     int accept(Visitor* v) override;
 };
 
+// Conversión explícita entre enteros: e as u8
+struct CastExp : public Exp {
+    Exp* e;
+    string type;       // tipo destino
+    CastExp(Exp* x, const std::string& t) : e(x), type(t) {}
+    int accept(Visitor* v) override;
+};
+
 struct FcallStm : public Stm {
     FcallExp* call;          
     FcallStm(FcallExp* c) : call(c) {}
     int accept(Visitor* v) override;
 };
 
+// Copia profunda de nodos (para pasadas que duplican código)
+Exp*  cloneExp(Exp* e);
+Stm*  cloneStm(Stm* s);
+Body* cloneBody(Body* b);
+
+// Consultas comunes a las pasadas sobre el AST
+bool isPure(Exp* e);                                 // sin llamadas ni operadores sobrecargados
+bool mentions(Exp* e, const string& name);           // lee la variable `name`
+void countLets(Body* b, unordered_map<string, int>& decls);   // lets por nombre, en todo el cuerpo
+void collectLets(Body* b, unordered_set<string>& names);
+
 
 
 #endif // AST_H
\ No newline at end of file
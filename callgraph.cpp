@@ -0,0 +1,107 @@
+#include "callgraph.h"
+#include <vector>
+
+using std::string;
+using std::unordered_set;
+
+// ----------------- Construcción -----------------
+
+// Las referencias a un nombre que es a la vez static y local cuentan como uso del
+// static: sobra alguno, pero nunca se quita uno vivo.
+void CallGraph::collect(Exp* e, unordered_set<string>& refs) {
+    if (!e) return;
+    if (auto id = dynamic_cast<IdExp*>(e)) refs.insert(id->value);
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        collect(b->left, refs);
+        collect(b->right, refs);
+        if (b->hasOverloadedImpl) refs.insert(b->implFuncName);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : f->argumentos) collect(a, refs);
+        refs.insert(f->nombre);
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) collect(fa->base, refs);
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        collect(ix->array, refs);
+        collect(ix->index, refs);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) collect(f.second, refs);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) collect(x, refs);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) collect(c->e, refs);
+}
+
+void CallGraph::collect(Body* b, unordered_set<string>& refs) {
+    if (!b) return;
+    for (auto v : b->vars) collect(v->e, refs);
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            collect(a->lhs, refs);
+            collect(a->e, refs);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  collect(p->e, refs);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) collect(r->e, refs);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            collect(i->condition, refs);
+            collect(i->then, refs);
+            collect(i->els, refs);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            collect(w->condition, refs);
+            collect(w->b, refs);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            collect(m->scrutinee, refs);
+            for (auto arm : m->arms) collect(arm->body, refs);
+            collect(m->otherwise, refs);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) collect(fs->call, refs);
+    }
+}
+
+void CallGraph::build(Program* p) {
+    edges.clear();
+    for (auto gv : p->vdlist) collect(gv->val, edges[gv->var]);
+    for (auto f : p->fdlist) collect(f->cuerpo, edges[f->nombre]);
+    for (auto impl : p->impls) {
+        string name = opImplName(impl);
+        if (!name.empty()) collect(impl->body, edges[name]);
+    }
+}
+
+// ----------------- Alcanzables -----------------
+
+void CallGraph::walk() {
+    reachable.clear();
+    std::vector<string> work = {root};
+    reachable.insert(root);
+    while (!work.empty()) {
+        string n = work.back();
+        work.pop_back();
+        auto it = edges.find(n);
+        if (it == edges.end()) continue;
+        for (auto &m : it->second) {
+            // solo los nombres que son nodos: los locales no se siguen
+            if (edges.count(m) && reachable.insert(m).second) work.push_back(m);
+        }
+    }
+}
+
+// ----------------- Pasada -----------------
+
+void CallGraph::optimize(Program* p) {
+    build(p);
+    if (!edges.count(root)) return;     // sin main no hay desde dónde recorrer
+    walk();
+
+    p->fdlist.remove_if([&](FunDec* f) { return !reachable.count(f->nombre); });
+    p->vdlist.remove_if([&](GlobalVar* gv) { return !reachable.count(gv->var); });
+    // un impl de un trait que no es operador no genera función: se deja
+    p->impls.remove_if([&](ImplDec* impl) {
+        string name = opImplName(impl);
+        return !name.empty() && !reachable.count(name);
+    });
+}
@@ -0,0 +1,33 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include "ast.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Grafo de llamadas y eliminación de código muerto. Cada función, operador
+// sobrecargado (__op_*) y static es un nodo; sus aristas son las llamadas directas
+// (f(...) como expresión o sentencia), los BinaryExp resueltos a un __op_* y las
+// lecturas de statics. Lo que no se alcanza desde main se quita del programa antes
+// de generar código: con los preludios de helpers compartidos, la mayoría de las
+// funciones no se usan. Las cadenas y las imágenes de .rodata se crean al generar
+// cada función, así que las de las funciones quitadas desaparecen con ellas.
+class CallGraph {
+public:
+    std::string root = "main";
+
+    void optimize(Program* p);
+
+    // nodo -> funciones y statics a los que hace referencia
+    std::unordered_map<std::string, std::unordered_set<std::string>> edges;
+    std::unordered_set<std::string> reachable;
+
+private:
+    void build(Program* p);
+    void collect(Exp* e, std::unordered_set<std::string>& refs);
+    void collect(Body* b, std::unordered_set<std::string>& refs);
+    void walk();
+};
+
+#endif
@@ -0,0 +1,43 @@
+struct Pixel {
+    r: u8,
+    g: u8,
+    b: u8,
+}
+
+struct Span {
+    lo: i64,
+    hi: i64,
+    step: i64,
+}
+
+struct Tile {
+    cells: [i32; 24],
+    id: i64,
+}
+
+fn main() {
+    let p: Pixel = Pixel { r: 10, g: 20, b: 30 };
+    let q: Pixel = Pixel { r: 0, g: 0, b: 0 };
+    let s: Span = Span { lo: 1, hi: 2, step: 3 };
+    let t: Span = Span { lo: 0, hi: 0, step: 0 };
+    let key: [u8; 13] = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13];
+    let k2: [u8; 13] = [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0];
+    let a: Tile = Tile { id: 7 };
+    let b: Tile = Tile { id: 0 };
+    let i: i64 = 0;
+    let acc: i64 = 0;
+
+    while (i < 100000) {
+        q = p;
+        t = s;
+        k2 = key;
+        a.cells[i - i / 24 * 24] = i as i32;
+        b = a;
+        acc = acc + q.g as i64 + t.hi + k2[12] as i64 + b.cells[i - i / 24 * 24] as i64 + b.id;
+        p.g = p.g + 1;
+        s.hi = s.hi + 1;
+        key[12] = key[12] + 3;
+        i = i + 1;
+    }
+    println!("{}", acc);
+}
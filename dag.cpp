@@ -218,6 +218,7 @@ int DAGOptimizer::visit(BinaryExp* exp)   { return 0; }
 int DAGOptimizer::visit(AssignStm* stm)   { return 0; }
 int DAGOptimizer::visit(PrintStm* stm)    { return 0; }
 int DAGOptimizer::visit(IfStm* stm)       { return 0; }
+int DAGOptimizer::visit(MatchStm* stm)    { return 0; }
 int DAGOptimizer::visit(WhileStm* stm)    { return 0; }
 int DAGOptimizer::visit(ReturnStm* stm)   { return 0; }
 int DAGOptimizer::visit(LetStm* stm)      { return 0; }
@@ -228,4 +229,5 @@ int DAGOptimizer::visit(StructField* exp) { return 0; }
 int DAGOptimizer::visit(StructDec* exp)   { return 0; }
 int DAGOptimizer::visit(ArrayLitExp* exp) { return 0; }
 int DAGOptimizer::visit(StringExp* exp)   { return 0; }
+int DAGOptimizer::visit(CastExp* exp)     { return 0; }
 int DAGOptimizer::visit(FcallStm* stm)    { return 0; }
@@ -23,6 +23,7 @@ public:
     int visit(AssignStm* stm) override;
     int visit(PrintStm* stm) override;
     int visit(IfStm* stm) override;
+    int visit(MatchStm* stm) override;
     int visit(WhileStm* stm) override;
     int visit(ReturnStm* stm) override;
     int visit(LetStm* stm) override;
@@ -33,6 +34,7 @@ public:
     int visit(StructDec* exp) override;
     int visit(ArrayLitExp* exp) override;
     int visit(StringExp* exp) override;
+    int visit(CastExp* exp) override;
     int visit(FcallStm* stm) override;
 };
 
@@ -0,0 +1,67 @@
+struct Punto {
+    x: i64,
+    y: i64,
+}
+
+static ESCALA: [i64; 4] = [3, 5, 7, 11];
+static mut CONTADOR: i64 = 0;
+static mut SINUSO: [i64; 4] = [1, 2, 3, 4];
+static MUERTA: [i64; 4] = [9, 8, 7, 6];
+
+impl Add for Punto {
+    type Output = Punto;
+    fn add(self, other: Punto) -> Punto {
+        let ans: Punto = Punto { x: self.x + other.x, y: self.y + other.y };
+        return ans;
+    }
+}
+
+impl Sub for Punto {
+    type Output = Punto;
+    fn sub(self, other: Punto) -> Punto {
+        let ans: Punto = Punto { x: self.x - other.x, y: self.y - other.y };
+        return ans;
+    }
+}
+
+fn registrar(n: i64) -> i64 {
+    println!("{}", "registro en uso");
+    CONTADOR = CONTADOR + n;
+    return(CONTADOR);
+}
+
+fn escalar(i: i64, k: i64) -> i64 {
+    if (k < 0) {
+        return(escalar(i, 0));
+    }
+    registrar(1);
+    return(ESCALA[i - i / 4 * 4] * k);
+}
+
+fn ayudamuerta(n: i64) -> i64 {
+    println!("{}", "nunca se imprime");
+    return(n + MUERTA[n - n / 4 * 4] + SINUSO[0] + ayudarecursiva(n));
+}
+
+fn ayudarecursiva(n: i64) -> i64 {
+    if (n < 1) {
+        return(0);
+    }
+    return(ayudamuerta(n - 1));
+}
+
+fn main() {
+    let i: i64 = 0;
+    let s: i64 = 0;
+    let p: Punto = Punto { x: 1, y: 2 };
+    let q: Punto = Punto { x: 10, y: 20 };
+    while (i < 10) {
+        s = s + escalar(i, i + 1);
+        i = i + 1;
+    }
+    p = p + q;
+    println!("{}", s);
+    println!("{}", p.x + p.y);
+    println!("{}", CONTADOR);
+    return(0);
+}
@@ -0,0 +1,66 @@
+struct Metros {
+    a: i64,
+    b: i64,
+}
+
+struct Pies {
+    a: i64,
+    b: i64,
+}
+
+impl Add for Metros {
+    type Output = Metros;
+    fn add(self, other: Metros) -> Metros {
+        let i: i64 = 0;
+        let s: i64 = 0;
+        while (i < self.a) {
+            s = s + other.b * i + self.b;
+            i = i + 1;
+        }
+        let ans: Metros = Metros { a: self.a + other.a, b: s - other.a * self.b + i * i };
+        return ans;
+    }
+}
+
+impl Add for Pies {
+    type Output = Pies;
+    fn add(self, other: Pies) -> Pies {
+        let i: i64 = 0;
+        let s: i64 = 0;
+        while (i < self.a) {
+            s = s + other.b * i + self.b;
+            i = i + 1;
+        }
+        let ans: Pies = Pies { a: self.a + other.a, b: s - other.a * self.b + i * i };
+        return ans;
+    }
+}
+
+fn normametros(p: Metros, k: i64) -> i64 {
+    if (k < 0) {
+        return(normametros(p, 0));
+    }
+    return(p.a * p.a + p.b * p.b + k);
+}
+
+fn normapies(p: Pies, k: i64) -> i64 {
+    if (k < 0) {
+        return(normapies(p, 0));
+    }
+    return(p.a * p.a + p.b * p.b + k);
+}
+
+fn main() {
+    let m: Metros = Metros { a: 3, b: 4 };
+    let n: Metros = Metros { a: 5, b: 6 };
+    let p: Pies = Pies { a: 7, b: 8 };
+    let q: Pies = Pies { a: 2, b: 9 };
+    m = m + n;
+    p = p + q;
+    m = m + n;
+    p = p + q;
+    println!("{}", normametros(m, 1));
+    println!("{}", normapies(p, 2));
+    println!("{}", m.b + p.b);
+    return(0);
+}
@@ -0,0 +1,44 @@
+fn codigo(op: i64, k: i64) -> i64 {
+    if (k < 0) {
+        return(codigo(op, 0));
+    }
+    let r: i64 = 0;
+    match (op) {
+        0 => { r = 10 + k }
+        1 => { r = 11 }
+        2 => { r = 12 * k }
+        3 => { r = 13 }
+        4 | 5 => { r = 45 }
+        6 => { r = 16 - k }
+        _ => { r = 0 - 1 }
+    }
+    return(r);
+}
+
+fn clave(op: i64, k: i64) -> i64 {
+    if (k < 0) {
+        return(clave(op, 0));
+    }
+    let r: i64 = 0;
+    match (op) {
+        0 => { r = 10 + k }
+        1 => { r = 11 }
+        2 => { r = 12 * k }
+        3 => { r = 13 }
+        4 | 5 => { r = 45 }
+        6 => { r = 16 - k }
+        _ => { r = 0 - 1 }
+    }
+    return(r);
+}
+
+fn main() {
+    let i: i64 = 0 - 1;
+    let s: i64 = 0;
+    while (i < 8) {
+        s = s + codigo(i, 3) * 100 + clave(7 - i, 2);
+        i = i + 1;
+    }
+    println!("{}", s);
+    return(0);
+}
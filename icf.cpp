@@ -0,0 +1,197 @@
+#include "icf.h"
+#include <vector>
+#include <sstream>
+#include <cctype>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+// helpers
+static std::string trim(const std::string& s) {
+    size_t i = 0, j = s.size();
+    while (i < j && std::isspace((unsigned char)s[i])) i++;
+    while (j > i && std::isspace((unsigned char)s[j-1])) j--;
+    return s.substr(i, j - i);
+}
+
+static std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static std::string joinLines(const std::vector<std::string>& lines) {
+    std::ostringstream oss;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        oss << lines[i];
+        if (i + 1 < lines.size()) oss << "\n";
+    }
+    return oss.str();
+}
+
+static bool isSymbolChar(char c) {
+    return std::isalnum((unsigned char)c) || c == '_' || c == '.';
+}
+
+// trozos de la línea: símbolos (etiquetas, mnemónicos, registros) y el resto tal cual
+static std::vector<std::string> tokenize(const std::string& line) {
+    std::vector<std::string> toks;
+    size_t i = 0;
+    while (i < line.size()) {
+        size_t j = i;
+        bool sym = isSymbolChar(line[i]);
+        while (j < line.size() && isSymbolChar(line[j]) == sym) j++;
+        toks.push_back(line.substr(i, j - i));
+        i = j;
+    }
+    return toks;
+}
+
+// "else_0:" -> "else_0"; "" si la línea no define una etiqueta
+static std::string labelOf(const std::string& line) {
+    std::string t = trim(line);
+    if (t.size() < 2 || t.back() != ':') return "";
+    std::string name = t.substr(0, t.size() - 1);
+    for (char c : name) if (!isSymbolChar(c)) return "";
+    return name;
+}
+
+// fin de una función: otra función, o datos/texto que no son suyos
+static bool endsFunction(const std::string& line) {
+    std::string t = trim(line);
+    return t.rfind(".globl ", 0) == 0 || t.rfind(".section", 0) == 0 ||
+           t == ".data" || t == ".text" || t == ".bss";
+}
+
+// Tabla de saltos de un match emitida en medio del cuerpo: ".section .rodata" ...
+// ".text". Devuelve la línea del ".text" que la cierra, o 0 si lines[i] no abre
+// una (la .rodata global del final no vuelve a .text).
+static size_t inlineRodataEnd(const std::vector<std::string>& lines, size_t i) {
+    if (trim(lines[i]) != ".section .rodata") return 0;
+    for (size_t j = i + 1; j < lines.size(); j++) {
+        if (trim(lines[j]) == ".text") return j;
+        if (endsFunction(lines[j])) return 0;
+    }
+    return 0;
+}
+
+namespace {
+struct Function {
+    std::string name;
+    size_t begin = 0, end = 0;                // [begin, end) en las líneas
+    std::unordered_set<std::string> labels;   // etiquetas definidas dentro, sin el nombre
+    std::string normalized;
+};
+}
+
+static void normalize(Function& fn, const std::vector<std::string>& lines) {
+    std::unordered_map<std::string, std::string> rename;
+    std::ostringstream oss;
+    for (size_t i = fn.begin; i < fn.end; i++) {
+        std::string t = trim(lines[i]);
+        if (t.empty() || t[0] == '#') continue;
+        for (auto &tok : tokenize(t)) {
+            if (tok == fn.name) oss << "<self>";
+            else if (fn.labels.count(tok)) {
+                auto it = rename.find(tok);
+                if (it == rename.end()) {
+                    it = rename.emplace(tok, "<L" + std::to_string(rename.size()) + ">").first;
+                }
+                oss << it->second;
+            }
+            else oss << tok;
+        }
+        oss << "\n";
+    }
+    fn.normalized = oss.str();
+}
+
+string IdenticalCodeFolding::optimize(const string& asmText) {
+    std::vector<std::string> lines = splitLines(asmText);
+
+    // 1) localizar las funciones: ".globl f" seguido de "f:"
+    std::vector<Function> fns;
+    for (size_t i = 0; i + 1 < lines.size(); i++) {
+        std::string t = trim(lines[i]);
+        if (t.rfind(".globl ", 0) != 0) continue;
+        std::string name = trim(t.substr(7));
+        if (labelOf(lines[i + 1]) != name) continue;
+        Function fn;
+        fn.name = name;
+        fn.begin = i;
+        size_t j = i + 2;
+        while (j < lines.size()) {
+            // la tabla forma parte de la función: sus etiquetas también se renombran
+            size_t close = endsFunction(lines[j]) ? inlineRodataEnd(lines, j) : 0;
+            if (endsFunction(lines[j]) && !close) break;
+            for (size_t k = j; k <= std::max(j, close); k++) {
+                std::string lbl = labelOf(lines[k]);
+                if (!lbl.empty()) fn.labels.insert(lbl);
+            }
+            j = std::max(j, close) + 1;
+        }
+        fn.end = j;
+        fns.push_back(fn);
+        i = j - 1;
+    }
+    if (fns.size() < 2) return asmText;
+
+    // 2) una función cuyas etiquetas internas se usan desde fuera no se puede quitar
+    std::unordered_map<std::string, int> uses;
+    for (auto &line : lines) {
+        for (auto &tok : tokenize(line)) uses[tok]++;
+    }
+    std::vector<bool> removable(fns.size(), true);
+    for (size_t k = 0; k < fns.size(); k++) {
+        Function& fn = fns[k];
+        std::unordered_map<std::string, int> inside;
+        for (size_t i = fn.begin; i < fn.end; i++) {
+            for (auto &tok : tokenize(lines[i])) {
+                if (fn.labels.count(tok)) inside[tok]++;
+            }
+        }
+        for (auto &p : inside) {
+            if (uses[p.first] != p.second) removable[k] = false;
+        }
+        normalize(fn, lines);
+    }
+
+    // 3) agrupar por hash y confirmar con el texto completo
+    std::unordered_map<size_t, std::vector<size_t>> byHash;
+    std::unordered_map<size_t, std::string> aliasOf;   // función -> la que se conserva
+    std::hash<std::string> hasher;
+    for (size_t k = 0; k < fns.size(); k++) {
+        std::vector<size_t>& group = byHash[hasher(fns[k].normalized)];
+        bool folded = false;
+        if (removable[k]) {
+            for (size_t other : group) {
+                if (fns[other].normalized == fns[k].normalized) {
+                    aliasOf[k] = fns[other].name;
+                    folded = true;
+                    break;
+                }
+            }
+        }
+        if (!folded) group.push_back(k);
+    }
+    if (aliasOf.empty()) return asmText;
+
+    // 4) reescribir: cada función plegada queda como alias de la conservada
+    std::vector<std::string> result;
+    size_t next = 0;
+    for (size_t k = 0; k < fns.size(); k++) {
+        auto it = aliasOf.find(k);
+        if (it == aliasOf.end()) continue;
+        for (; next < fns[k].begin; next++) result.push_back(lines[next]);
+        result.push_back(".globl " + fns[k].name);
+        result.push_back(".set " + fns[k].name + ", " + it->second);
+        next = fns[k].end;
+    }
+    for (; next < lines.size(); next++) result.push_back(lines[next]);
+    return joinLines(result) + "\n";
+}
@@ -0,0 +1,22 @@
+#ifndef ICF_H
+#define ICF_H
+
+#include <string>
+
+using namespace std;
+
+// Plegado de código idéntico (ICF) sobre el ensamblador ya generado. Cada función
+// (de su .globl hasta la siguiente directiva de sección o .globl, sin contar las
+// tablas de saltos de sus match, que van en .rodata y vuelven a .text) se normaliza:
+// sin comentarios, sus etiquetas locales renombradas por orden de aparición y las
+// referencias a sí misma (recursión) sustituidas por un marcador. Dos funciones con
+// el mismo texto normalizado hacen lo mismo, así que solo se conserva la primera y
+// el nombre de la otra pasa a ser un alias con .set: los impl de operadores sobre
+// structs con la misma forma y los helpers clonados por struct ocupan una vez la
+// caché de instrucciones.
+class IdenticalCodeFolding {
+public:
+    static string optimize(const string& asmText);
+};
+
+#endif
@@ -0,0 +1,30 @@
+struct Big {
+    a: i64,
+    b: i64,
+    c: i64,
+    d: i64,
+    e: i64,
+    f: i64,
+    g: i64,
+    h: i64,
+}
+
+static mut S: Big = Big { a: 5, b: 0, c: 0, d: 0, e: 0, f: 0, g: 0, h: 0 };
+
+fn main() {
+    let p: Big = Big { a: 1, b: 0, c: 0, d: 0, e: 0, f: 0, g: 0, h: 0 };
+    let arr: [i64; 8] = [1, 2, 3, 4, 5, 6, 7, 8];
+    let m: [Big; 2] = [Big { a: 1, b: 2, c: 0, d: 0, e: 0, f: 0, g: 0, h: 0 }, Big { a: 3, b: 4, c: 0, d: 0, e: 0, f: 0, g: 0, h: 0 }];
+    let i: i64 = 1;
+    p = Big { a: p.a + 10, b: 2, c: 3, d: 4, e: 5, f: 6, g: 7, h: 8 };
+    println!("{}", p.a);
+    arr = [arr[0] + 100, 0, 2, 3, 4, 5, 6, 9];
+    println!("{}", arr[0]);
+    S = Big { a: 1, b: S.a + 1, c: 3, d: 4, e: 5, f: 6, g: 7, h: S.a };
+    println!("{}", S.b);
+    println!("{}", S.h);
+    m[i] = Big { a: m[i].a + 1, b: m[i].a, c: 3, d: 4, e: 5, f: 6, g: 7, h: 8 };
+    println!("{}", m[1].a);
+    println!("{}", m[1].b);
+    return(0);
+}
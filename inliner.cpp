@@ -0,0 +1,680 @@
+#include "inliner.h"
+#include "loopopt.h"
+#include "visitor.h"
+#include <functional>
+#include <unordered_set>
+
+using std::list;
+using std::string;
+using std::unordered_map;
+using std::unordered_set;
+using std::vector;
+
+// ----------------- Helpers -----------------
+
+static bool isScalarType(const string& t) {
+    return isIntType(t) || t == "String";
+}
+
+static IdExp* makeId(const string& name, const string& type) {
+    IdExp* id = new IdExp(name);
+    id->ty = type;
+    return id;
+}
+
+static void collectIds(Exp* e, unordered_set<string>& ids);
+
+static void collectIds(Body* b, unordered_set<string>& ids) {
+    if (!b) return;
+    for (auto v : b->vars) collectIds(v->e, ids);
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            collectIds(a->lhs, ids);
+            collectIds(a->e, ids);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  collectIds(p->e, ids);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) collectIds(r->e, ids);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            collectIds(i->condition, ids);
+            collectIds(i->then, ids);
+            collectIds(i->els, ids);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            collectIds(w->condition, ids);
+            collectIds(w->b, ids);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            collectIds(m->scrutinee, ids);
+            for (auto arm : m->arms) collectIds(arm->body, ids);
+            collectIds(m->otherwise, ids);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) collectIds(fs->call, ids);
+    }
+}
+
+static void collectIds(Exp* e, unordered_set<string>& ids) {
+    if (!e) return;
+    if (auto id = dynamic_cast<IdExp*>(e)) ids.insert(id->value);
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        collectIds(b->left, ids);
+        collectIds(b->right, ids);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : f->argumentos) collectIds(a, ids);
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) collectIds(fa->base, ids);
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        collectIds(ix->array, ids);
+        collectIds(ix->index, ids);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) collectIds(f.second, ids);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) collectIds(x, ids);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) collectIds(c->e, ids);
+}
+
+// llamadas (por nombre de función o de __op_*) dentro de un cuerpo
+static void collectCalls(Exp* e, unordered_map<string, int>& calls);
+
+static void collectCalls(Body* b, unordered_map<string, int>& calls) {
+    if (!b) return;
+    for (auto v : b->vars) collectCalls(v->e, calls);
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            collectCalls(a->lhs, calls);
+            collectCalls(a->e, calls);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  collectCalls(p->e, calls);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) collectCalls(r->e, calls);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            collectCalls(i->condition, calls);
+            collectCalls(i->then, calls);
+            collectCalls(i->els, calls);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            collectCalls(w->condition, calls);
+            collectCalls(w->b, calls);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            collectCalls(m->scrutinee, calls);
+            for (auto arm : m->arms) collectCalls(arm->body, calls);
+            collectCalls(m->otherwise, calls);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) collectCalls(fs->call, calls);
+    }
+}
+
+static void collectCalls(Exp* e, unordered_map<string, int>& calls) {
+    if (!e) return;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        collectCalls(b->left, calls);
+        collectCalls(b->right, calls);
+        if (b->hasOverloadedImpl) calls[b->implFuncName]++;
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : f->argumentos) collectCalls(a, calls);
+        calls[f->nombre]++;
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) collectCalls(fa->base, calls);
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        collectCalls(ix->array, calls);
+        collectCalls(ix->index, calls);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) collectCalls(f.second, calls);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) collectCalls(x, calls);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) collectCalls(c->e, calls);
+}
+
+static bool hasNestedLets(Body* b) {
+    if (!b) return false;
+    for (auto s : b->StmList) {
+        if (auto i = dynamic_cast<IfStm*>(s)) {
+            if ((i->then && !i->then->vars.empty()) || (i->els && !i->els->vars.empty())) return true;
+            if (hasNestedLets(i->then) || hasNestedLets(i->els)) return true;
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            if (!w->b->vars.empty() || hasNestedLets(w->b)) return true;
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            for (auto arm : m->arms) {
+                if (!arm->body->vars.empty() || hasNestedLets(arm->body)) return true;
+            }
+            if (m->otherwise && (!m->otherwise->vars.empty() || hasNestedLets(m->otherwise))) return true;
+        }
+    }
+    return false;
+}
+
+// ¿escribe el cuerpo en la variable `name` o en alguna parte de ella (name.x, name[i])?
+static bool writesRoot(Body* b, const string& name) {
+    if (!b) return false;
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            Exp* root = a->lhs;
+            while (true) {
+                if (auto fa = dynamic_cast<FieldAccessExp*>(root)) root = fa->base;
+                else if (auto ix = dynamic_cast<IndexExp*>(root)) root = ix->array;
+                else break;
+            }
+            auto id = dynamic_cast<IdExp*>(root);
+            if (id && id->value == name) return true;
+        }
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            if (writesRoot(i->then, name) || writesRoot(i->els, name)) return true;
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            if (writesRoot(w->b, name)) return true;
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            for (auto arm : m->arms) if (writesRoot(arm->body, name)) return true;
+            if (writesRoot(m->otherwise, name)) return true;
+        }
+    }
+    return false;
+}
+
+static bool containsReturn(Body* b) {
+    if (!b) return false;
+    for (auto s : b->StmList) {
+        if (dynamic_cast<ReturnStm*>(s)) return true;
+        if (auto i = dynamic_cast<IfStm*>(s)) {
+            if (containsReturn(i->then) || containsReturn(i->els)) return true;
+        }
+        if (auto w = dynamic_cast<WhileStm*>(s)) {
+            if (containsReturn(w->b)) return true;
+        }
+        if (auto m = dynamic_cast<MatchStm*>(s)) {
+            for (auto arm : m->arms) if (containsReturn(arm->body)) return true;
+            if (containsReturn(m->otherwise)) return true;
+        }
+    }
+    return false;
+}
+
+// ¿todos los caminos de la lista terminan en un return?
+static bool alwaysReturns(const list<Stm*>& stms) {
+    for (auto s : stms) {
+        if (dynamic_cast<ReturnStm*>(s)) return true;
+        if (auto i = dynamic_cast<IfStm*>(s)) {
+            if (i->then && i->els && alwaysReturns(i->then->StmList) &&
+                alwaysReturns(i->els->StmList)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Convierte los return de la lista en uniones: cada return(e) pasa a ser
+// onReturn(e) y lo que seguía detrás de un if que retorna se mueve a la rama
+// que no lo hace, de modo que todos los caminos terminan al final de la lista.
+// Falla si hay un return dentro de un while o si habría que duplicar código.
+static bool lowerReturns(list<Stm*>& stms, const std::function<Stm*(Exp*)>& onReturn) {
+    for (auto it = stms.begin(); it != stms.end(); ++it) {
+        if (auto r = dynamic_cast<ReturnStm*>(*it)) {
+            stms.erase(std::next(it), stms.end());     // código muerto tras el return
+            Stm* a = onReturn(r->e);
+            if (a) *it = a;
+            else stms.erase(it);
+            return true;
+        }
+        if (auto w = dynamic_cast<WhileStm*>(*it)) {
+            if (containsReturn(w->b)) return false;
+            continue;
+        }
+        if (auto m = dynamic_cast<MatchStm*>(*it)) {
+            for (auto arm : m->arms) if (containsReturn(arm->body)) return false;
+            if (containsReturn(m->otherwise)) return false;
+            continue;
+        }
+        auto i = dynamic_cast<IfStm*>(*it);
+        if (!i || (!containsReturn(i->then) && !containsReturn(i->els))) continue;
+
+        if (!i->els) i->els = new Body();
+        list<Stm*> rest(std::next(it), stms.end());
+        stms.erase(std::next(it), stms.end());
+
+        bool thenRet = alwaysReturns(i->then->StmList);
+        bool elsRet  = alwaysReturns(i->els->StmList);
+        if (!rest.empty() && !(thenRet && elsRet)) {
+            if (thenRet)     i->els->StmList.splice(i->els->StmList.end(), rest);
+            else if (elsRet) i->then->StmList.splice(i->then->StmList.end(), rest);
+            else return false;
+        }
+        return lowerReturns(i->then->StmList, onReturn) &&
+               lowerReturns(i->els->StmList, onReturn);
+    }
+    return true;
+}
+
+// Sustituye variables por expresiones (renombrado de locales, paso de argumentos)
+static Exp* substitute(Exp* e, const unordered_map<string, Exp*>& sub);
+
+static void substitute(list<Stm*>& stms, const unordered_map<string, Exp*>& sub) {
+    for (auto s : stms) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            a->lhs = substitute(a->lhs, sub);
+            a->e   = substitute(a->e, sub);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  p->e = substitute(p->e, sub);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) r->e = substitute(r->e, sub);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            i->condition = substitute(i->condition, sub);
+            if (i->then) substitute(i->then->StmList, sub);
+            if (i->els)  substitute(i->els->StmList, sub);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            w->condition = substitute(w->condition, sub);
+            substitute(w->b->StmList, sub);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            m->scrutinee = substitute(m->scrutinee, sub);
+            for (auto arm : m->arms) substitute(arm->body->StmList, sub);
+            if (m->otherwise) substitute(m->otherwise->StmList, sub);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) substitute(fs->call, sub);
+    }
+}
+
+static Exp* substitute(Exp* e, const unordered_map<string, Exp*>& sub) {
+    if (!e) return e;
+    if (auto id = dynamic_cast<IdExp*>(e)) {
+        auto it = sub.find(id->value);
+        return it == sub.end() ? e : cloneExp(it->second);
+    }
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        b->left  = substitute(b->left, sub);
+        b->right = substitute(b->right, sub);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto &a : f->argumentos) a = substitute(a, sub);
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) fa->base = substitute(fa->base, sub);
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        ix->array = substitute(ix->array, sub);
+        ix->index = substitute(ix->index, sub);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) f.second = substitute(f.second, sub);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto &x : al->elems) x = substitute(x, sub);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) c->e = substitute(c->e, sub);
+    return e;
+}
+
+static bool isDirectArg(Exp* e, const unordered_map<string, string>& vars) {
+    if (dynamic_cast<NumberExp*>(e) || dynamic_cast<StringExp*>(e)) return true;
+    if (auto id = dynamic_cast<IdExp*>(e)) return vars.count(id->value) > 0;
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return isDirectArg(fa->base, vars);
+    if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        return isDirectArg(ix->array, vars) && isPure(ix->index);
+    }
+    return false;
+}
+
+// ----------------- Inliner -----------------
+
+void Inliner::optimize(Program* p) {
+    if (!p) return;
+
+    // candidatos: funciones y operadores sobrecargados
+    for (auto f : p->fdlist) {
+        if (f->nombre == "main") continue;
+        bool scalarParams = true;
+        for (auto &t : f->Ptipos) scalarParams = scalarParams && isScalarType(t);
+        if (!scalarParams) continue;     // structs/arrays se pasan por puntero
+
+        Callee c;
+        c.params  = f->Pnombres;
+        c.ptypes  = f->Ptipos;
+        c.retType = f->tipo;
+        c.body    = f->cuerpo;
+        callees[f->nombre] = c;
+    }
+    for (auto impl : p->impls) {
+        string name = opImplName(impl);
+        if (name.empty()) continue;
+
+        Callee c;
+        c.params     = {"self", impl->paramName};
+        c.ptypes     = {impl->typeName, impl->paramType};
+        c.retType    = impl->returnType;
+        c.body       = impl->body;
+        c.isOperator = true;
+        callees[name] = c;
+    }
+
+    // descartar recursivos, los que usan nombres libres (globales) y los que
+    // no admiten convertir sus return en uniones
+    for (auto it = callees.begin(); it != callees.end(); ) {
+        const string& name = it->first;
+        Callee& c = it->second;
+
+        unordered_map<string, int> calls;
+        collectCalls(c.body, calls);
+
+        unordered_set<string> ids, known(c.params.begin(), c.params.end());
+        collectIds(c.body, ids);
+        for (auto v : c.body->vars) known.insert(v->id);
+        bool freeNames = false;
+        for (auto &id : ids) freeNames = freeNames || !known.count(id);
+
+        Body* probe = cloneBody(c.body);
+        bool lowerable = lowerReturns(probe->StmList, [](Exp*) { return (Stm*)nullptr; });
+
+        if (calls.count(name) || freeNames || hasNestedLets(c.body) || !lowerable) {
+            it = callees.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (callees.empty()) return;
+
+    for (auto f : p->fdlist) collectCalls(f->cuerpo, callSites);
+    for (auto impl : p->impls) collectCalls(impl->body, callSites);
+
+    for (auto f : p->fdlist) {
+        inlineFunction(f->cuerpo, f->Pnombres, f->Ptipos, f->tipo);
+    }
+    for (auto impl : p->impls) {
+        inlineFunction(impl->body, {"self", impl->paramName}, {impl->typeName, impl->paramType},
+                       impl->returnType);
+    }
+}
+
+bool Inliner::shouldInline(const string& name) {
+    auto it = callees.find(name);
+    if (it == callees.end()) return false;
+
+    int size = countNodes(it->second.body);
+    if (size <= callOverhead) return true;
+    if (size > sizeThreshold) return false;
+
+    // cada sitio extra duplica el cuerpo: limitar el crecimiento total
+    int sites = callSites[name];
+    return (sites - 1) * (size - callOverhead) <= growthBudget;
+}
+
+IdExp* Inliner::declare(const string& name, const string& type) {
+    // las variables nuevas se declaran sin inicializar en el nivel superior:
+    // el generador de código sólo reserva frame para esos let
+    fnBody->vars.push_back(new LetStm(name, type, nullptr, true));
+    fnVars[name] = type;
+    return makeId(name, type);
+}
+
+void Inliner::inlineFunction(Body* cuerpo, const vector<string>& params,
+                             const vector<string>& ptypes, const string& retType) {
+    if (!cuerpo) return;
+    fnBody = cuerpo;
+    fnRetType = retType;
+    fnVars.clear();
+    for (size_t i = 0; i < params.size(); ++i) fnVars[params[i]] = ptypes[i];
+    for (auto v : cuerpo->vars) fnVars[v->id] = v->type;
+
+    // Los let del nivel superior se inicializan a la entrada de la función. Desde el
+    // primero cuya inicialización tiene llamadas a expandir, sus inicializaciones
+    // pasan a ser asignaciones al principio del cuerpo, en el mismo orden.
+    list<Stm*> head;
+    bool moving = false;
+    for (auto v : cuerpo->vars) {
+        if (!moving && v->e) {
+            unordered_map<string, int> calls;
+            collectCalls(v->e, calls);
+            for (auto &c : calls) moving = moving || shouldInline(c.first);
+        }
+        if (moving && v->e) {
+            head.push_back(new AssignStm(makeId(v->id, v->type), v->e));
+            v->e = nullptr;
+        }
+    }
+    cuerpo->StmList.splice(cuerpo->StmList.begin(), head);
+
+    inlineBody(cuerpo);
+}
+
+void Inliner::inlineBody(Body* b) {
+    if (!b) return;
+    list<Stm*> result;
+    for (auto s : b->StmList) {
+        if (auto i = dynamic_cast<IfStm*>(s)) {
+            inlineBody(i->then);
+            inlineBody(i->els);
+        } else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            inlineBody(w->b);
+        } else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            for (auto arm : m->arms) inlineBody(arm->body);
+            inlineBody(m->otherwise);
+        }
+
+        list<Stm*> pre;
+        Stm* ns = inlineStm(s, pre);
+        result.splice(result.end(), pre);
+        if (ns) result.push_back(ns);
+    }
+    b->StmList = result;
+}
+
+// Expande las llamadas de la sentencia; el código copiado va a `pre`.
+// Devuelve la sentencia reescrita o nullptr si desaparece.
+Stm* Inliner::inlineStm(Stm* s, list<Stm*>& pre) {
+    bool barrier = false;
+
+    if (auto a = dynamic_cast<AssignStm*>(s)) {
+        // x = f(...): el callee escribe su resultado directamente en x
+        auto target = dynamic_cast<IdExp*>(a->lhs);
+        auto call   = dynamic_cast<FcallExp*>(a->e);
+        auto op     = dynamic_cast<BinaryExp*>(a->e);
+        string name = call ? call->nombre : (op && op->hasOverloadedImpl ? op->implFuncName : "");
+        if (target && fnVars.count(target->value) && !name.empty() && shouldInline(name) &&
+            !mentions(a->e, target->value)) {
+            vector<Exp*> args;
+            if (call) {
+                for (auto &x : call->argumentos) x = expand(x, pre, barrier);
+                args = call->argumentos;
+            } else {
+                op->left  = expand(op->left, pre, barrier);
+                op->right = expand(op->right, pre, barrier);
+                args = {op->left, op->right};
+            }
+            if (!barrier) {
+                inlineCall(name, args, pre, target);
+                return nullptr;
+            }
+            return s;
+        }
+        a->lhs = expand(a->lhs, pre, barrier);
+        a->e   = expand(a->e, pre, barrier);
+        return s;
+    }
+    if (auto p = dynamic_cast<PrintStm*>(s)) {
+        p->e = expand(p->e, pre, barrier);
+        return s;
+    }
+    if (auto r = dynamic_cast<ReturnStm*>(s)) {
+        // return(f(...)): los return del callee son los del llamador; así una
+        // llamada en cola dentro del callee sigue estando en cola
+        auto call = dynamic_cast<FcallExp*>(r->e);
+        if (call && shouldInline(call->nombre) && isScalarType(fnRetType) &&
+            callees[call->nombre].retType == fnRetType &&
+            alwaysReturns(callees[call->nombre].body->StmList)) {
+            for (auto &x : call->argumentos) x = expand(x, pre, barrier);
+            if (barrier) return s;
+            inlineCall(call->nombre, call->argumentos, pre, nullptr, true);
+            return nullptr;
+        }
+        r->e = expand(r->e, pre, barrier);
+        return s;
+    }
+    if (auto i = dynamic_cast<IfStm*>(s)) {
+        i->condition = expand(i->condition, pre, barrier);
+        return s;
+    }
+    if (auto m = dynamic_cast<MatchStm*>(s)) {
+        m->scrutinee = expand(m->scrutinee, pre, barrier);
+        return s;
+    }
+    if (auto fs = dynamic_cast<FcallStm*>(s)) {
+        for (auto &a : fs->call->argumentos) a = expand(a, pre, barrier);
+        if (barrier || !shouldInline(fs->call->nombre)) return s;
+        inlineCall(fs->call->nombre, fs->call->argumentos, pre, nullptr);
+        return nullptr;                 // el resultado, si lo hay, se descarta
+    }
+    // la condición de un while se evalúa en cada vuelta: se deja como está
+    return s;
+}
+
+// Recorre la expresión en el orden de evaluación del generador de código y expande
+// las llamadas candidatas. Tras la primera llamada que se queda como call (barrier)
+// ya no se expande nada más: el código copiado se ejecuta antes que la sentencia y
+// adelantarlo a esa llamada cambiaría el orden de los efectos.
+Exp* Inliner::expand(Exp* e, list<Stm*>& pre, bool& barrier) {
+    if (!e) return e;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        b->left  = expand(b->left, pre, barrier);
+        b->right = expand(b->right, pre, barrier);
+        if (!b->hasOverloadedImpl) return b;
+        if (!barrier && shouldInline(b->implFuncName)) {
+            return inlineCall(b->implFuncName, {b->left, b->right}, pre, nullptr);
+        }
+        barrier = true;
+        return b;
+    }
+    if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto &a : f->argumentos) a = expand(a, pre, barrier);
+        if (!barrier && shouldInline(f->nombre) && callees[f->nombre].retType != "void") {
+            return inlineCall(f->nombre, f->argumentos, pre, nullptr);
+        }
+        barrier = true;
+        return f;
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        fa->base = expand(fa->base, pre, barrier);
+        return fa;
+    }
+    if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        ix->array = expand(ix->array, pre, barrier);
+        ix->index = expand(ix->index, pre, barrier);
+        return ix;
+    }
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        // los campos se evalúan en el orden de la declaración del struct
+        auto itS = structTable.find(sl->nombre);
+        if (itS == structTable.end()) {
+            barrier = true;
+            return sl;
+        }
+        for (auto &fname : itS->second.fieldOrder) {
+            for (auto &f : sl->fields) {
+                if (f.first == fname) f.second = expand(f.second, pre, barrier);
+            }
+        }
+        return sl;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto &x : al->elems) x = expand(x, pre, barrier);
+        return al;
+    }
+    if (auto c = dynamic_cast<CastExp*>(e)) {
+        c->e = expand(c->e, pre, barrier);
+        return c;
+    }
+    return e;
+}
+
+// Copia el cuerpo del callee en `pre` y devuelve la expresión con su resultado
+// (la variable destino, un temporal nuevo o nullptr si es void).
+Exp* Inliner::inlineCall(const string& name, const vector<Exp*>& args,
+                         list<Stm*>& pre, IdExp* target, bool keepReturns) {
+    Callee& c = callees[name];
+    string pfx = "__inl" + std::to_string(nextId++) + "_";
+    Body* body = cloneBody(c.body);
+    unordered_map<string, Exp*> sub;
+
+    // parámetros: el argumento se usa tal cual si es un camino sin efectos y el
+    // callee no lo modifica; si no, se copia a un local nuevo
+    for (size_t i = 0; i < c.params.size() && i < args.size(); ++i) {
+        const string& p = c.params[i];
+        if (isDirectArg(args[i], fnVars) && !writesRoot(body, p)) {
+            sub[p] = args[i];
+        } else {
+            IdExp* tmp = declare(pfx + p, c.ptypes[i]);
+            pre.push_back(new AssignStm(tmp, args[i]));
+            sub[p] = makeId(tmp->value, tmp->ty);
+        }
+    }
+
+    // si todos los return devuelven el mismo local, ese local es el resultado
+    string retLocal;
+    std::function<bool(Body*)> sameLocal = [&](Body* b) -> bool {
+        if (!b) return true;
+        for (auto s : b->StmList) {
+            if (auto r = dynamic_cast<ReturnStm*>(s)) {
+                auto id = dynamic_cast<IdExp*>(r->e);
+                if (!id) return false;
+                if (retLocal.empty()) retLocal = id->value;
+                if (id->value != retLocal) return false;
+            }
+            else if (auto i = dynamic_cast<IfStm*>(s)) {
+                if (!sameLocal(i->then) || !sameLocal(i->els)) return false;
+            }
+        }
+        return true;
+    };
+    bool aliasRet = false;
+    if (!keepReturns && c.retType != "void" && sameLocal(body) && !retLocal.empty()) {
+        for (auto v : body->vars) {
+            aliasRet = aliasRet || (v->id == retLocal && v->type == c.retType);
+        }
+    }
+
+    IdExp* result = nullptr;
+    if (!keepReturns && c.retType != "void") {
+        result = target ? target : declare(pfx + "ret", c.retType);
+    }
+
+    // locales del callee: renombrados y declarados en el llamador
+    list<Stm*> stms;
+    for (auto v : body->vars) {
+        IdExp* local;
+        if (aliasRet && v->id == retLocal) {
+            local = makeId(result->value, result->ty);
+        } else {
+            local = declare(pfx + v->id, v->type);
+        }
+        sub[v->id] = local;
+        if (v->e) stms.push_back(new AssignStm(makeId(local->value, local->ty), v->e));
+    }
+    stms.splice(stms.end(), body->StmList);
+
+    substitute(stms, sub);
+
+    if (keepReturns) {
+        pre.splice(pre.end(), stms);
+        return nullptr;
+    }
+
+    // return(e) -> resultado = e; el final del cuerpo copiado es la unión
+    string resName = result ? result->value : "";
+    lowerReturns(stms, [&](Exp* e) -> Stm* {
+        if (!result) {
+            auto call = dynamic_cast<FcallExp*>(e);
+            return call ? new FcallStm(call) : nullptr;
+        }
+        auto id = dynamic_cast<IdExp*>(e);
+        if (id && id->value == resName) return nullptr;
+        return new AssignStm(makeId(resName, result->ty), e);
+    });
+
+    pre.splice(pre.end(), stms);
+    return result ? makeId(result->value, result->ty) : nullptr;
+}
@@ -0,0 +1,52 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+#include "ast.h"
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Inlining sobre el AST: las llamadas a funciones pequeñas no recursivas y a los
+// operadores sobrecargados (__op_*) se sustituyen por una copia del cuerpo del
+// callee. Los parámetros y locales del callee pasan a ser variables del llamador
+// (renombradas) y cada return se convierte en una asignación al resultado seguida
+// de la unión al final del cuerpo copiado.
+class Inliner {
+public:
+    int sizeThreshold = 40;    // nodos máximos del cuerpo del callee
+    int growthBudget  = 120;   // crecimiento máximo (nodos) con varios sitios de llamada
+    int callOverhead  = 8;     // por debajo de este tamaño siempre compensa
+
+    void optimize(Program* p);
+
+private:
+    struct Callee {
+        std::vector<std::string> params;
+        std::vector<std::string> ptypes;
+        std::string retType;
+        Body* body = nullptr;
+        bool isOperator = false;
+    };
+
+    std::unordered_map<std::string, Callee> callees;    // nombre o __op_* -> callee
+    std::unordered_map<std::string, int> callSites;
+    int nextId = 0;
+
+    // función que recibe el código
+    Body* fnBody = nullptr;
+    std::unordered_map<std::string, std::string> fnVars;   // locales visibles -> tipo
+    std::string fnRetType;
+
+    bool shouldInline(const std::string& name);
+    void inlineFunction(Body* cuerpo, const std::vector<std::string>& params,
+                        const std::vector<std::string>& ptypes, const std::string& retType);
+    void inlineBody(Body* b);
+    Stm* inlineStm(Stm* s, std::list<Stm*>& pre);
+    Exp* expand(Exp* e, std::list<Stm*>& pre, bool& barrier);
+    Exp* inlineCall(const std::string& name, const std::vector<Exp*>& args,
+                    std::list<Stm*>& pre, IdExp* target, bool keepReturns = false);
+    IdExp* declare(const std::string& name, const std::string& type);
+};
+
+#endif
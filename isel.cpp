@@ -0,0 +1,287 @@
+#include "isel.h"
+#include "visitor.h"
+#include <cstring>
+#include <cstdint>
+
+using std::string;
+using std::vector;
+
+// ----------------- Tabla de patrones -----------------
+// Costes aproximados en ciclos; a igual coste gana el primero de la tabla.
+
+static const TreePattern patternTable[] = {
+    // valor en %rax
+    {IselGoal::Reg,  "(add x:reg i:imm)",              1,  "addq {i}, %rax", nullptr},
+    {IselGoal::Reg,  "(add i:imm x:reg)",              1,  "addq {i}, %rax", nullptr},
+    {IselGoal::Reg,  "(add x:reg m:mem)",              1,  "addq {m}, %rax", nullptr},
+    {IselGoal::Reg,  "(add m:mem x:reg)",              1,  "addq {m}, %rax", nullptr},
+    {IselGoal::Reg,  "(add (mul x:reg s:scale) i:imm)", 1, "leaq {i.v}(,%rax,{s.v}), %rax", nullptr},
+    {IselGoal::Reg,  "(add (mul x:reg #3) i:imm)",     1,  "leaq {i.v}(%rax,%rax,2), %rax", nullptr},
+    {IselGoal::Reg,  "(add (mul x:reg #5) i:imm)",     1,  "leaq {i.v}(%rax,%rax,4), %rax", nullptr},
+    {IselGoal::Reg,  "(add (mul x:reg #9) i:imm)",     1,  "leaq {i.v}(%rax,%rax,8), %rax", nullptr},
+    {IselGoal::Reg,  "(sub x:reg i:imm)",              1,  "subq {i}, %rax", nullptr},
+    {IselGoal::Reg,  "(sub x:reg m:mem)",              1,  "subq {m}, %rax", nullptr},
+    {IselGoal::Reg,  "(sub i:imm x:reg)",              2,  "negq %rax\naddq {i}, %rax", nullptr},
+    {IselGoal::Reg,  "(mul x:reg s:scale)",            1,  "salq ${s.log}, %rax", nullptr},
+    {IselGoal::Reg,  "(mul s:scale x:reg)",            1,  "salq ${s.log}, %rax", nullptr},
+    {IselGoal::Reg,  "(mul x:reg #3)",                 1,  "leaq (%rax,%rax,2), %rax", nullptr},
+    {IselGoal::Reg,  "(mul x:reg #5)",                 1,  "leaq (%rax,%rax,4), %rax", nullptr},
+    {IselGoal::Reg,  "(mul x:reg #9)",                 1,  "leaq (%rax,%rax,8), %rax", nullptr},
+    {IselGoal::Reg,  "(mul x:reg i:imm)",              3,  "imulq {i}, %rax", nullptr},
+    {IselGoal::Reg,  "(mul i:imm x:reg)",              3,  "imulq {i}, %rax", nullptr},
+    {IselGoal::Reg,  "(mul x:reg m:mem)",              3,  "imulq {m}, %rax", nullptr},
+    {IselGoal::Reg,  "(mul m:mem x:reg)",              3,  "imulq {m}, %rax", nullptr},
+    // división con signo por 2^k: se suma 2^k-1 a los negativos para truncar hacia 0
+    {IselGoal::Reg,  "(div x:reg s:scale)",            4,
+        "movq %rax, %rdx\nsarq $63, %rdx\nshrq ${s.rlog}, %rdx\naddq %rdx, %rax\nsarq ${s.log}, %rax", nullptr},
+    {IselGoal::Reg,  "(div x:reg m:mem)",              20, "cqto\nidivq {m}", nullptr},
+    {IselGoal::Reg,  "(div x:reg i:imm)",              21, "movq {i}, %rcx\ncqto\nidivq %rcx", nullptr},
+    {IselGoal::Reg,  "(lt x:reg #0)",                  1,  "shrq $63, %rax", nullptr},
+    {IselGoal::Reg,  "(lt #0 x:reg)",                  3,  "testq %rax, %rax\nsetg %al\nmovzbq %al, %rax", nullptr},
+    {IselGoal::Reg,  "(lt x:reg i:imm)",               3,  "cmpq {i}, %rax\nsetl %al\nmovzbq %al, %rax", nullptr},
+    {IselGoal::Reg,  "(lt x:reg m:mem)",               3,  "cmpq {m}, %rax\nsetl %al\nmovzbq %al, %rax", nullptr},
+    {IselGoal::Reg,  "(lt i:imm x:reg)",               3,  "cmpq {i}, %rax\nsetg %al\nmovzbq %al, %rax", nullptr},
+    {IselGoal::Reg,  "(lt m:mem x:reg)",               3,  "cmpq {m}, %rax\nsetg %al\nmovzbq %al, %rax", nullptr},
+
+    // asignaciones: lectura-modificación-escritura sobre la memoria destino
+    {IselGoal::Stmt, "(set m:mem (add m #1))",         1,  "incq {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (add #1 m))",         1,  "incq {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (sub m #1))",         1,  "decq {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (add m i:imm))",      1,  "addq {i}, {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (add i:imm m))",      1,  "addq {i}, {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (sub m i:imm))",      1,  "subq {i}, {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (mul m s:scale))",    1,  "salq ${s.log}, {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (add m x:reg))",      1,  "addq %rax, {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (add x:reg m))",      1,  "addq %rax, {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem (sub m x:reg))",      1,  "subq %rax, {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem i:imm)",              1,  "movq {i}, {m}", nullptr},
+    {IselGoal::Stmt, "(set m:mem x:reg)",              1,  "movq %rax, {m}", nullptr},
+
+    // condiciones de if/while: comparación y salto, sin materializar el booleano
+    {IselGoal::Cond, "(lt x:reg #0)",                  1,  "testq %rax, %rax", "jns"},
+    {IselGoal::Cond, "(lt #0 x:reg)",                  1,  "testq %rax, %rax", "jle"},
+    {IselGoal::Cond, "(lt m:mem i:imm)",               1,  "cmpq {i}, {m}", "jge"},
+    {IselGoal::Cond, "(lt i:imm m:mem)",               1,  "cmpq {i}, {m}", "jle"},
+    {IselGoal::Cond, "(lt x:reg i:imm)",               1,  "cmpq {i}, %rax", "jge"},
+    {IselGoal::Cond, "(lt x:reg m:mem)",               1,  "cmpq {m}, %rax", "jge"},
+    {IselGoal::Cond, "(lt i:imm x:reg)",               1,  "cmpq {i}, %rax", "jle"},
+    {IselGoal::Cond, "(lt m:mem x:reg)",               1,  "cmpq {m}, %rax", "jle"},
+    {IselGoal::Cond, "x:reg",                          1,  "testq %rax, %rax", "je"},
+};
+
+// ----------------- Helpers -----------------
+
+static const char* opName(BinaryOp op) {
+    switch (op) {
+        case PLUS_OP:  return "add";
+        case MINUS_OP: return "sub";
+        case MUL_OP:   return "mul";
+        case DIV_OP:   return "div";
+        case LT_OP:    return "lt";
+        default:       return "";
+    }
+}
+
+static string invertJump(const string& j) {
+    if (j == "je")  return "jne";
+    if (j == "jns") return "js";
+    if (j == "jle") return "jg";
+    if (j == "jge") return "jl";
+    return "";
+}
+
+static int log2Of(int v) {
+    return __builtin_ctz(v);
+}
+
+static string nextToken(const char*& s) {
+    while (*s == ' ') s++;
+    if (*s == '(' || *s == ')') return string(1, *s++);
+    const char* b = s;
+    while (*s && *s != ' ' && *s != '(' && *s != ')') s++;
+    return string(b, s);
+}
+
+InstructionSelector::PNode InstructionSelector::parse(const char*& s) {
+    PNode n;
+    string tok = nextToken(s);
+    if (tok == "(") {
+        n.kind = PNode::Op;
+        n.name = nextToken(s);
+        while (true) {
+            const char* save = s;
+            if (nextToken(s) == ")") break;
+            s = save;
+            n.kids.push_back(parse(s));
+        }
+    } else if (tok[0] == '#') {
+        n.kind = PNode::Const;
+        n.value = std::stoi(tok.substr(1));
+    } else if (tok.find(':') != string::npos) {
+        n.kind = PNode::Bind;
+        n.name = tok.substr(0, tok.find(':'));
+        n.nt = tok.substr(tok.find(':') + 1);
+    } else {
+        n.kind = PNode::Ref;
+        n.name = tok;
+    }
+    return n;
+}
+
+// ----------------- InstructionSelector -----------------
+
+InstructionSelector::InstructionSelector(GenCodeVisitor& gen, std::ostream& out)
+    : gen(gen), out(out) {
+    for (auto& p : patternTable) {
+        const char* s = p.tree;
+        rules.push_back({&p, parse(s)});
+    }
+}
+
+bool InstructionSelector::bindLeaf(const string& nt, Exp* e, Binding& b, int& cost) {
+    auto num = dynamic_cast<NumberExp*>(e);
+    b.e = e;
+    b.nt = nt;
+    if (nt == "imm" || nt == "scale") {
+        if (!num || num->value < INT32_MIN || num->value > INT32_MAX) return false;
+        if (nt == "scale" && num->value != 2 && num->value != 4 && num->value != 8) return false;
+        b.value = num->value;
+        b.opnd = "$" + std::to_string(num->value);
+        return true;
+    }
+    if (nt == "mem") {
+        if (num || !gen.fixedAddress(e) || !gen.directOperand(e, b.opnd)) return false;
+        memReads++;
+        return true;
+    }
+    if (nt == "reg") {
+        // cargar una hoja cuesta una instrucción; un subárbol, al menos dos
+        cost += (num || gen.fixedAddress(e)) ? 1 : 2;
+        return true;
+    }
+    return false;
+}
+
+bool InstructionSelector::match(const PNode& p, Exp* e, Bindings& b, int& cost) {
+    switch (p.kind) {
+        case PNode::Op: {
+            auto bin = dynamic_cast<BinaryExp*>(e);
+            if (!bin || bin->hasOverloadedImpl || p.name != opName(bin->op)) return false;
+            // aritmética en i32/u32/u8: hay que truncar el resultado, y eso solo lo
+            // hace el generador tras el valor de la raíz
+            if (isNarrowInt(bin->ty) && bin->op != LT_OP && bin != narrowRoot) return false;
+            return p.kids.size() == 2 && match(p.kids[0], bin->left, b, cost) &&
+                   match(p.kids[1], bin->right, b, cost);
+        }
+        case PNode::Const: {
+            auto num = dynamic_cast<NumberExp*>(e);
+            return num && num->value == p.value;
+        }
+        case PNode::Bind: {
+            Binding leaf;
+            if (b.count(p.name) || !bindLeaf(p.nt, e, leaf, cost)) return false;
+            b[p.name] = leaf;
+            return true;
+        }
+        case PNode::Ref: {
+            auto it = b.find(p.name);
+            if (it == b.end()) return false;
+            Binding leaf;
+            int ignored = 0;
+            return bindLeaf(it->second.nt, e, leaf, ignored) && leaf.opnd == it->second.opnd;
+        }
+    }
+    return false;
+}
+
+// Elige el patrón más barato para la raíz y lo emite: primero el subárbol reg
+// (con el generador), después la plantilla.
+bool InstructionSelector::select(IselGoal goal, Exp* lhs, Exp* e, const string& label, bool onTrue,
+                                 string* flags) {
+    const Rule* best = nullptr;
+    Bindings bestB;
+    int bestCost = 0;
+
+    for (auto& r : rules) {
+        if (r.pat->goal != goal) continue;
+        Bindings b;
+        int cost = r.pat->cost;
+        bool ok = true;
+        const PNode* tree = &r.tree;
+        if (goal == IselGoal::Stmt) {
+            int dstCost = 0;
+            ok = match(r.tree.kids[0], lhs, b, dstCost);
+            tree = &r.tree.kids[1];
+        }
+        memReads = 0;
+        narrowRoot = goal == IselGoal::Reg ? e : nullptr;
+        if (!ok || !match(*tree, e, b, cost)) continue;
+
+        // el subárbol reg se calcula antes de leer los operandos de memoria del
+        // patrón: si contiene llamadas podría cambiarlos
+        Exp* reg = nullptr;
+        for (auto& kv : b) {
+            if (kv.second.nt == "reg") reg = kv.second.e;
+        }
+        if (reg && memReads && !callFree(reg)) continue;
+
+        if (!best || cost < bestCost) {
+            best = &r;
+            bestB = b;
+            bestCost = cost;
+        }
+    }
+    if (!best) return false;
+
+    for (auto& kv : bestB) {
+        if (kv.second.nt == "reg") kv.second.e->accept(&gen);
+    }
+
+    // plantilla: {x} operando, {x.v} valor, {x.log}, {x.rlog}
+    string t = best->pat->tmpl, line;
+    for (size_t i = 0; i <= t.size(); i++) {
+        if (i == t.size() || t[i] == '\n') {
+            if (!line.empty()) out << " " << line << "\n";
+            line.clear();
+        } else if (t[i] == '{') {
+            size_t close = t.find('}', i);
+            string key = t.substr(i + 1, close - i - 1), field;
+            if (key.find('.') != string::npos) {
+                field = key.substr(key.find('.') + 1);
+                key = key.substr(0, key.find('.'));
+            }
+            const Binding& bind = bestB[key];
+            if (field.empty())        line += bind.opnd;
+            else if (field == "v")    line += std::to_string(bind.value);
+            else if (field == "log")  line += std::to_string(log2Of(bind.value));
+            else if (field == "rlog") line += std::to_string(64 - log2Of(bind.value));
+            i = close;
+        } else {
+            line += t[i];
+        }
+    }
+
+    if (goal == IselGoal::Cond) {
+        string j = best->pat->jfalse;
+        if (onTrue) j = invertJump(j);
+        if (flags) *flags = j.substr(1);
+        else out << " " << j << " " << label << "\n";
+    }
+    return true;
+}
+
+bool InstructionSelector::selectExp(BinaryExp* e) {
+    return select(IselGoal::Reg, nullptr, e, "", false);
+}
+
+bool InstructionSelector::selectAssign(Exp* lhs, Exp* rhs) {
+    return select(IselGoal::Stmt, lhs, rhs, "", false);
+}
+
+bool InstructionSelector::selectCond(Exp* cond, const string& label, bool onTrue) {
+    return select(IselGoal::Cond, nullptr, cond, label, onTrue);
+}
+
+bool InstructionSelector::selectFlags(Exp* cond, string& ccFalse) {
+    return select(IselGoal::Cond, nullptr, cond, "", false, &ccFalse);
+}
@@ -0,0 +1,78 @@
+#ifndef ISEL_H
+#define ISEL_H
+
+#include "ast.h"
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GenCodeVisitor;
+
+// Selección de instrucciones por patrones de árbol (estilo BURS). Cada patrón
+// describe un árbol de la expresión, su coste y la plantilla x86-64 que lo
+// implementa; para cada nodo se elige el patrón aplicable más barato.
+//
+// Sintaxis de los árboles:
+//   (op hijo...)   op: add sub mul div lt, y set (asignación) en la raíz
+//   x:reg          subárbol cualquiera, calculado en %rax (como mucho uno)
+//   x:imm          constante inmediata         x:mem    escalar en dirección fija
+//   x:scale        constante 2, 4 u 8          x        mismo operando que x
+//   #k             la constante k
+// En las plantillas {x} es el operando, {x.v} su valor, {x.log} log2 y
+// {x.rlog} 64 - log2. Las líneas se separan con '\n'.
+enum class IselGoal { Reg, Stmt, Cond };
+
+struct TreePattern {
+    IselGoal goal;
+    const char* tree;
+    int cost;
+    const char* tmpl;
+    const char* jfalse;    // Cond: salto cuando la condición es falsa
+};
+
+class InstructionSelector {
+public:
+    InstructionSelector(GenCodeVisitor& gen, std::ostream& out);
+
+    bool selectExp(BinaryExp* e);                                  // valor en %rax
+    bool selectAssign(Exp* lhs, Exp* rhs);                          // lhs = rhs
+    // salta a `label` si la condición es falsa (o verdadera con onTrue)
+    bool selectCond(Exp* cond, const std::string& label, bool onTrue = false);
+    // solo la comparación; ccFalse es el sufijo (ge, le, e...) que indica "falsa"
+    bool selectFlags(Exp* cond, std::string& ccFalse);
+
+private:
+    struct PNode {
+        enum Kind { Op, Bind, Ref, Const } kind;
+        std::string name;      // operador o variable
+        std::string nt;        // reg, imm, mem, scale
+        int value = 0;
+        std::vector<PNode> kids;
+    };
+    struct Binding {
+        Exp* e = nullptr;
+        std::string nt;
+        std::string opnd;
+        int value = 0;
+    };
+    typedef std::unordered_map<std::string, Binding> Bindings;
+    struct Rule {
+        const TreePattern* pat;
+        PNode tree;
+    };
+
+    GenCodeVisitor& gen;
+    std::ostream& out;
+    std::vector<Rule> rules;
+    int memReads = 0;      // operandos de memoria leídos por el patrón en curso
+    Exp* narrowRoot = nullptr;   // raíz de valor: su truncado lo emite el generador
+
+    static PNode parse(const char*& s);
+    bool match(const PNode& p, Exp* e, Bindings& b, int& cost);
+    bool bindLeaf(const std::string& nt, Exp* e, Binding& b, int& cost);
+    bool select(IselGoal goal, Exp* lhs, Exp* e, const std::string& label, bool onTrue,
+                std::string* flags = nullptr);
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include "layout.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+using std::string;
+using std::vector;
+
+std::unordered_map<string, StructInfo> structTable;
+bool g_reorderFields = true;
+
+bool isArrayType(const string& t) {
+    return !t.empty() && t.front() == '[' && t.back() == ']';
+}
+
+void parseArrayType(const string& t, string& elemType, int& length) {
+    size_t semi  = t.find(';');
+    size_t close = t.rfind(']');
+    if (semi == string::npos || close == string::npos) {
+        elemType = "i64";
+        length = 1;
+        return;
+    }
+    elemType = t.substr(1, semi - 1);
+    string nStr = t.substr(semi + 1, close - semi - 1);
+    length = std::stoi(nStr);
+}
+
+bool isIntType(const string& t) {
+    return t == "i64" || t == "bool" || isNarrowInt(t);
+}
+
+bool isNarrowInt(const string& t) {
+    return t == "i32" || t == "u32" || t == "u8";
+}
+
+bool isAggregateType(const string& t) {
+    return structTable.count(t) || isArrayType(t);
+}
+
+int typeSize(const string& t) {
+    auto it = structTable.find(t);
+    if (it != structTable.end()) return it->second.totalSize;
+    if (isArrayType(t)) {
+        string elem;
+        int len;
+        parseArrayType(t, elem, len);
+        return len * typeSize(elem);
+    }
+    if (t == "bool" || t == "u8") return 1;
+    if (t == "i32" || t == "u32") return 4;
+    return 8;
+}
+
+int typeAlign(const string& t) {
+    auto it = structTable.find(t);
+    if (it != structTable.end()) return it->second.align;
+    if (isArrayType(t)) {
+        string elem;
+        int len;
+        parseArrayType(t, elem, len);
+        return typeAlign(elem);
+    }
+    return typeSize(t);
+}
+
+static std::unordered_set<string> inLayout;   // structs a medio disponer
+
+const StructInfo& layoutStruct(StructDec* s, const std::list<StructDec*>& decls) {
+    auto done = structTable.find(s->nombre);
+    if (done != structTable.end()) return done->second;
+    if (!inLayout.insert(s->nombre).second) {
+        throw std::runtime_error("Struct recursivo por valor: " + s->nombre);
+    }
+
+    StructInfo info;
+    auto itType = s->body->types.begin();
+    for (auto& name : s->body->atributes) {
+        info.fieldOrder.push_back(name);
+        info.fieldType[name] = *itType;
+        ++itType;
+
+        // tamaño y alineación de un campo struct (también como elemento de array)
+        string base = info.fieldType[name];
+        while (isArrayType(base)) {
+            string elem;
+            int len;
+            parseArrayType(base, elem, len);
+            base = elem;
+        }
+        for (auto d : decls) {
+            if (d->nombre == base) layoutStruct(d, decls);
+        }
+    }
+
+    vector<string> placed = info.fieldOrder;
+    if (g_reorderFields) {
+        std::stable_sort(placed.begin(), placed.end(), [&](const string& a, const string& b) {
+            return typeAlign(info.fieldType[a]) > typeAlign(info.fieldType[b]);
+        });
+    }
+
+    int off = 0;
+    for (auto& name : placed) {
+        const string& t = info.fieldType[name];
+        int a = typeAlign(t);
+        off = (off + a - 1) / a * a;
+        info.fieldOffset[name] = off;
+        off += typeSize(t);
+        info.align = std::max(info.align, a);
+    }
+    info.totalSize = (off + info.align - 1) / info.align * info.align;
+
+    inLayout.erase(s->nombre);
+    return structTable[s->nombre] = std::move(info);
+}
+
+int paramRegs(ParamPass pass, const string& t) {
+    return pass == ParamPass::Registers ? (typeSize(t) + 7) / 8 : 1;
+}
+
+vector<ParamPass> classifyParams(const vector<string>& types, int firstReg) {
+    vector<ParamPass> passes;
+    int reg = firstReg;
+    for (auto& t : types) {
+        ParamPass pass = ParamPass::Scalar;
+        if (structTable.count(t) || isArrayType(t)) {
+            // el último trozo se carga con movq/movl/movzwl/movzbl: 3, 5, 6 y 7 bytes no
+            int size = typeSize(t), tail = size % 8;
+            bool fits = size <= 16 && reg + (size + 7) / 8 <= numArgRegs;
+            pass = fits && (tail == 0 || tail == 1 || tail == 2 || tail == 4)
+                 ? ParamPass::Registers : ParamPass::Reference;
+        }
+        reg += paramRegs(pass, t);
+        passes.push_back(pass);
+    }
+    return passes;
+}
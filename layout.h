@@ -0,0 +1,55 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "ast.h"
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Disposición en memoria de los tipos. Cada struct se dispone una sola vez (lo
+// pide el typechecker y lo reutilizan el generador y la emisión de .data):
+// cada campo va alineado a su tipo, bool ocupa un byte y, con g_reorderFields,
+// los campos se colocan de mayor a menor alineación para no dejar relleno. El
+// orden de declaración (fieldOrder) se conserva para evaluar los literales.
+struct StructInfo {
+    std::vector<std::string> fieldOrder;
+    std::unordered_map<std::string,int> fieldOffset;
+    std::unordered_map<std::string,std::string> fieldType;
+
+    int totalSize = 0;  // tamaño en bytes del struct completo
+    int align = 1;
+};
+
+extern std::unordered_map<std::string, StructInfo> structTable;
+extern bool g_reorderFields;
+
+// Enteros: i64, i32, u32, u8 y bool (0/1). En registros y en los slots de 8
+// bytes de las variables van siempre extendidos a 64 bits (con signo i32, con
+// ceros u32 y u8); solo como campo de struct o elemento de array ocupan su tamaño.
+bool isIntType(const std::string& t);
+bool isNarrowInt(const std::string& t);  // i32, u32, u8: se truncan tras operar
+
+// Arrays "[T; N]": único parser del tipo, para el typechecker, las pasadas y el generador
+bool isArrayType(const std::string& t);
+void parseArrayType(const std::string& t, std::string& elemType, int& length);
+bool isAggregateType(const std::string& t);   // struct o array: vive en memoria, no en un registro
+
+int typeSize(const std::string& t);      // bytes en memoria (campo o elemento de array)
+int typeAlign(const std::string& t);
+// decls: todos los structs del programa; un campo de un struct declarado más abajo
+// se dispone antes (el orden del fuente no importa). Un struct que se contiene a
+// sí mismo por valor es un error.
+const StructInfo& layoutStruct(StructDec* s, const std::list<StructDec*>& decls = {});
+
+// Paso de parámetros (SysV x86-64; solo hay clase INTEGER). Un escalar va en un
+// registro. Un struct o array de hasta 16 bytes va por valor en uno o dos
+// registros seguidos, uno por cada 8 bytes. Uno más grande, o uno para el que ya
+// no quedan registros, va por referencia oculta: su dirección en un registro, y
+// el callee solo lo copia si lo modifica. firstReg = registros ya ocupados (sret).
+enum class ParamPass { Scalar, Registers, Reference };
+const int numArgRegs = 6;
+std::vector<ParamPass> classifyParams(const std::vector<std::string>& types, int firstReg);
+int paramRegs(ParamPass pass, const std::string& t);   // registros que ocupa
+
+#endif
@@ -0,0 +1,502 @@
+#include "loopopt.h"
+#include <vector>
+#include <algorithm>
+
+using std::string;
+using std::unordered_map;
+using std::unordered_set;
+using std::vector;
+
+// ----------------- Helpers -----------------
+
+static int countNodes(Exp* e);
+
+static int countNodes(Stm* s) {
+    if (auto let = dynamic_cast<LetStm*>(s))   return 1 + countNodes(let->e);
+    if (auto a = dynamic_cast<AssignStm*>(s))  return 1 + countNodes(a->lhs) + countNodes(a->e);
+    if (auto p = dynamic_cast<PrintStm*>(s))   return 1 + countNodes(p->e);
+    if (auto r = dynamic_cast<ReturnStm*>(s))  return 1 + countNodes(r->e);
+    if (auto i = dynamic_cast<IfStm*>(s)) {
+        return 1 + countNodes(i->condition) + countNodes(i->then) + countNodes(i->els);
+    }
+    if (auto w = dynamic_cast<WhileStm*>(s))   return 1 + countNodes(w->condition) + countNodes(w->b);
+    if (auto m = dynamic_cast<MatchStm*>(s)) {
+        int n = 1 + countNodes(m->scrutinee) + countNodes(m->otherwise);
+        for (auto arm : m->arms) n += countNodes(arm->body);
+        return n;
+    }
+    if (auto fs = dynamic_cast<FcallStm*>(s))  return countNodes(fs->call);
+    return 1;
+}
+
+int countNodes(Body* b) {
+    if (!b) return 0;
+    int n = 0;
+    for (auto v : b->vars)    n += countNodes(v);
+    for (auto s : b->StmList) n += countNodes(s);
+    return n;
+}
+
+static int countNodes(Exp* e) {
+    if (!e) return 0;
+    if (auto b = dynamic_cast<BinaryExp*>(e))      return 1 + countNodes(b->left) + countNodes(b->right);
+    if (auto f = dynamic_cast<FcallExp*>(e)) {
+        int n = 1;
+        for (auto a : f->argumentos) n += countNodes(a);
+        return n;
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return 1 + countNodes(fa->base);
+    if (auto ix = dynamic_cast<IndexExp*>(e))       return 1 + countNodes(ix->array) + countNodes(ix->index);
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        int n = 1;
+        for (auto &f : sl->fields) n += countNodes(f.second);
+        return n;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        int n = 1;
+        for (auto x : al->elems) n += countNodes(x);
+        return n;
+    }
+    if (auto c = dynamic_cast<CastExp*>(e)) return 1 + countNodes(c->e);
+    return 1;
+}
+
+static bool bodyWritesVar(Body* b, const string& name);
+
+// ¿la sentencia puede escribir la variable escalar `name`?
+static bool stmWritesVar(Stm* s, const string& name) {
+    if (auto let = dynamic_cast<LetStm*>(s)) return let->id == name;
+    if (auto a = dynamic_cast<AssignStm*>(s)) {
+        auto id = dynamic_cast<IdExp*>(a->lhs);
+        return id && id->value == name;
+    }
+    if (auto i = dynamic_cast<IfStm*>(s)) {
+        return bodyWritesVar(i->then, name) || bodyWritesVar(i->els, name);
+    }
+    if (auto w = dynamic_cast<WhileStm*>(s)) return bodyWritesVar(w->b, name);
+    if (auto m = dynamic_cast<MatchStm*>(s)) {
+        for (auto arm : m->arms) if (bodyWritesVar(arm->body, name)) return true;
+        return bodyWritesVar(m->otherwise, name);
+    }
+    return false;
+}
+
+static bool bodyWritesVar(Body* b, const string& name) {
+    if (!b) return false;
+    for (auto v : b->vars)    if (stmWritesVar(v, name)) return true;
+    for (auto s : b->StmList) if (stmWritesVar(s, name)) return true;
+    return false;
+}
+
+static BinaryExp* makeBinary(Exp* l, Exp* r, BinaryOp op) {
+    BinaryExp* b = new BinaryExp(l, r, op);
+    b->hasOverloadedImpl = false;
+    b->ty = "i64";
+    return b;
+}
+
+bool matchCountedLoop(WhileStm* w, const unordered_set<string>& locals, CountedLoop& info) {
+    auto cond = dynamic_cast<BinaryExp*>(w->condition);
+    if (!cond || cond->op != LT_OP || cond->hasOverloadedImpl) return false;
+
+    auto iv = dynamic_cast<IdExp*>(cond->left);
+    if (!iv || !locals.count(iv->value)) return false;
+    if (iv->ty != "i64") return false;        // i32/u32/u8 se truncan al avanzar
+
+    if (auto bid = dynamic_cast<IdExp*>(cond->right)) {
+        if (bid->value == iv->value || !locals.count(bid->value)) return false;
+        if (bodyWritesVar(w->b, bid->value)) return false;
+    } else if (!dynamic_cast<NumberExp*>(cond->right)) {
+        return false;
+    }
+
+    if (!w->b || !w->b->vars.empty() || w->b->StmList.empty()) return false;
+
+    // la última sentencia debe ser iv = iv + c, con c > 0
+    auto inc = dynamic_cast<AssignStm*>(w->b->StmList.back());
+    if (!inc) return false;
+    auto lhs = dynamic_cast<IdExp*>(inc->lhs);
+    auto rhs = dynamic_cast<BinaryExp*>(inc->e);
+    if (!lhs || lhs->value != iv->value || !rhs || rhs->op != PLUS_OP) return false;
+    auto rl = dynamic_cast<IdExp*>(rhs->left);
+    auto rc = dynamic_cast<NumberExp*>(rhs->right);
+    if (!rl || rl->value != iv->value || !rc || rc->value <= 0) return false;
+
+    // ninguna otra sentencia del cuerpo puede tocar iv
+    auto last = std::prev(w->b->StmList.end());
+    for (auto it = w->b->StmList.begin(); it != last; ++it) {
+        if (stmWritesVar(*it, iv->value)) return false;
+    }
+
+    info.iv    = iv->value;
+    info.bound = cond->right;
+    info.step  = rc->value;
+    return true;
+}
+
+static bool isI64Array(Exp* e) {
+    auto id = dynamic_cast<IdExp*>(e);
+    if (!id) return false;
+    const string& t = id->ty;
+    return t.size() > 5 && t.front() == '[' && t.back() == ']' && t.compare(0, 5, "[i64;") == 0;
+}
+
+// operando de la forma a[iv] (se devuelve el IdExp del array) o una constante
+static Exp* elementOperand(Exp* e, const string& iv) {
+    if (dynamic_cast<NumberExp*>(e)) return e;
+    auto ix = dynamic_cast<IndexExp*>(e);
+    if (!ix || !isI64Array(ix->array)) return nullptr;
+    auto idx = dynamic_cast<IdExp*>(ix->index);
+    if (!idx || idx->value != iv) return nullptr;
+    return ix->array;
+}
+
+bool matchElementwiseLoop(WhileStm* w, const unordered_set<string>& locals, ElementwiseLoop& info) {
+    CountedLoop cl;
+    if (!matchCountedLoop(w, locals, cl) || cl.step != 1) return false;
+    if (w->b->StmList.size() != 2) return false;
+
+    auto asg = dynamic_cast<AssignStm*>(w->b->StmList.front());
+    if (!asg) return false;
+    auto dst = dynamic_cast<IndexExp*>(asg->lhs);
+    if (!dst || !isI64Array(dst->array)) return false;
+    auto dIdx = dynamic_cast<IdExp*>(dst->index);
+    if (!dIdx || dIdx->value != cl.iv) return false;
+
+    auto bin = dynamic_cast<BinaryExp*>(asg->e);
+    if (!bin || bin->hasOverloadedImpl) return false;
+    if (bin->op != PLUS_OP && bin->op != MINUS_OP && bin->op != LT_OP) return false;
+
+    Exp* l = elementOperand(bin->left, cl.iv);
+    Exp* r = elementOperand(bin->right, cl.iv);
+    if (!l || !r) return false;
+    if (dynamic_cast<NumberExp*>(l) && dynamic_cast<NumberExp*>(r)) return false;
+
+    info.iv    = cl.iv;
+    info.bound = cl.bound;
+    info.dst   = static_cast<IdExp*>(dst->array);
+    info.left  = l;
+    info.right = r;
+    info.op    = bin->op;
+    return true;
+}
+
+// ---- lecturas de variables (para saber si iv sigue viva) ----
+
+static int countVarReads(Exp* e, const string& name);
+static int countVarReads(Stm* s, const string& name);
+
+static int countVarReads(Exp* e, const string& name) {
+    if (!e) return 0;
+    if (auto id = dynamic_cast<IdExp*>(e)) return id->value == name ? 1 : 0;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        return countVarReads(b->left, name) + countVarReads(b->right, name);
+    }
+    if (auto f = dynamic_cast<FcallExp*>(e)) {
+        int n = 0;
+        for (auto a : f->argumentos) n += countVarReads(a, name);
+        return n;
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return countVarReads(fa->base, name);
+    if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        return countVarReads(ix->array, name) + countVarReads(ix->index, name);
+    }
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        int n = 0;
+        for (auto &f : sl->fields) n += countVarReads(f.second, name);
+        return n;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        int n = 0;
+        for (auto x : al->elems) n += countVarReads(x, name);
+        return n;
+    }
+    if (auto c = dynamic_cast<CastExp*>(e)) return countVarReads(c->e, name);
+    return 0;
+}
+
+static int countVarReads(Stm* s, const string& name) {
+    if (auto let = dynamic_cast<LetStm*>(s))  return countVarReads(let->e, name);
+    if (auto a = dynamic_cast<AssignStm*>(s)) {
+        int n = countVarReads(a->e, name);
+        if (!dynamic_cast<IdExp*>(a->lhs)) n += countVarReads(a->lhs, name);
+        return n;
+    }
+    if (auto p = dynamic_cast<PrintStm*>(s))  return countVarReads(p->e, name);
+    if (auto r = dynamic_cast<ReturnStm*>(s)) return countVarReads(r->e, name);
+    if (auto i = dynamic_cast<IfStm*>(s)) {
+        return countVarReads(i->condition, name) + countVarReads(i->then, name) +
+               countVarReads(i->els, name);
+    }
+    if (auto w = dynamic_cast<WhileStm*>(s)) {
+        return countVarReads(w->condition, name) + countVarReads(w->b, name);
+    }
+    if (auto m = dynamic_cast<MatchStm*>(s)) {
+        int n = countVarReads(m->scrutinee, name) + countVarReads(m->otherwise, name);
+        for (auto arm : m->arms) n += countVarReads(arm->body, name);
+        return n;
+    }
+    if (auto fs = dynamic_cast<FcallStm*>(s)) return countVarReads(fs->call, name);
+    return 0;
+}
+
+int countVarReads(Body* b, const string& name) {
+    if (!b) return 0;
+    int n = 0;
+    for (auto v : b->vars)    n += countVarReads(v, name);
+    for (auto s : b->StmList) n += countVarReads(s, name);
+    return n;
+}
+
+// ---- accesos a[iv] ----
+
+static void collectIndexed(Exp* e, const string& iv, vector<string>& arrays, int& uses);
+static void collectIndexed(Body* b, const string& iv, vector<string>& arrays, int& uses);
+
+static void collectIndexed(Stm* s, const string& iv, vector<string>& arrays, int& uses) {
+    if (auto let = dynamic_cast<LetStm*>(s))  collectIndexed(let->e, iv, arrays, uses);
+    else if (auto a = dynamic_cast<AssignStm*>(s)) {
+        collectIndexed(a->lhs, iv, arrays, uses);
+        collectIndexed(a->e, iv, arrays, uses);
+    }
+    else if (auto p = dynamic_cast<PrintStm*>(s))  collectIndexed(p->e, iv, arrays, uses);
+    else if (auto r = dynamic_cast<ReturnStm*>(s)) collectIndexed(r->e, iv, arrays, uses);
+    else if (auto i = dynamic_cast<IfStm*>(s)) {
+        collectIndexed(i->condition, iv, arrays, uses);
+        collectIndexed(i->then, iv, arrays, uses);
+        collectIndexed(i->els, iv, arrays, uses);
+    }
+    else if (auto w = dynamic_cast<WhileStm*>(s)) {
+        collectIndexed(w->condition, iv, arrays, uses);
+        collectIndexed(w->b, iv, arrays, uses);
+    }
+    else if (auto m = dynamic_cast<MatchStm*>(s)) {
+        collectIndexed(m->scrutinee, iv, arrays, uses);
+        for (auto arm : m->arms) collectIndexed(arm->body, iv, arrays, uses);
+        collectIndexed(m->otherwise, iv, arrays, uses);
+    }
+    else if (auto fs = dynamic_cast<FcallStm*>(s)) collectIndexed(fs->call, iv, arrays, uses);
+}
+
+static void collectIndexed(Body* b, const string& iv, vector<string>& arrays, int& uses) {
+    if (!b) return;
+    for (auto v : b->vars)    collectIndexed(v, iv, arrays, uses);
+    for (auto s : b->StmList) collectIndexed(s, iv, arrays, uses);
+}
+
+static void collectIndexed(Exp* e, const string& iv, vector<string>& arrays, int& uses) {
+    if (!e) return;
+    if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        auto arr = dynamic_cast<IdExp*>(ix->array);
+        auto idx = dynamic_cast<IdExp*>(ix->index);
+        const string& t = arr ? arr->ty : string();
+        if (arr && idx && idx->value == iv && !t.empty() && t.front() == '[') {
+            if (std::find(arrays.begin(), arrays.end(), arr->value) == arrays.end()) {
+                arrays.push_back(arr->value);
+            }
+            uses++;
+            return;
+        }
+        collectIndexed(ix->array, iv, arrays, uses);
+        collectIndexed(ix->index, iv, arrays, uses);
+        return;
+    }
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        collectIndexed(b->left, iv, arrays, uses);
+        collectIndexed(b->right, iv, arrays, uses);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : f->argumentos) collectIndexed(a, iv, arrays, uses);
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) collectIndexed(fa->base, iv, arrays, uses);
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) collectIndexed(f.second, iv, arrays, uses);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) collectIndexed(x, iv, arrays, uses);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) collectIndexed(c->e, iv, arrays, uses);
+}
+
+// iv = iv + c con c > 0
+static bool isIncrementOf(Stm* s, const string& iv) {
+    auto a = dynamic_cast<AssignStm*>(s);
+    if (!a) return false;
+    auto lhs = dynamic_cast<IdExp*>(a->lhs);
+    auto rhs = dynamic_cast<BinaryExp*>(a->e);
+    if (!lhs || lhs->value != iv || !rhs || rhs->op != PLUS_OP) return false;
+    auto rl = dynamic_cast<IdExp*>(rhs->left);
+    auto rc = dynamic_cast<NumberExp*>(rhs->right);
+    return rl && rl->value == iv && rc && rc->value > 0;
+}
+
+bool matchInductionLoop(WhileStm* w, const unordered_set<string>& locals, InductionLoop& info) {
+    auto cond = dynamic_cast<BinaryExp*>(w->condition);
+    if (!cond || cond->op != LT_OP || cond->hasOverloadedImpl) return false;
+    if (!w->b || !w->b->vars.empty()) return false;
+
+    // lado izquierdo: iv o iv + k
+    IdExp* iv = dynamic_cast<IdExp*>(cond->left);
+    int k = 0;
+    if (!iv) {
+        auto sum = dynamic_cast<BinaryExp*>(cond->left);
+        if (!sum || sum->op != PLUS_OP || sum->hasOverloadedImpl) return false;
+        iv = dynamic_cast<IdExp*>(sum->left);
+        auto kn = dynamic_cast<NumberExp*>(sum->right);
+        if (!iv || !kn || kn->value < 0) return false;
+        k = kn->value;
+    }
+    if (!locals.count(iv->value)) return false;
+
+    if (auto bid = dynamic_cast<IdExp*>(cond->right)) {
+        if (bid->value == iv->value || !locals.count(bid->value)) return false;
+        if (bodyWritesVar(w->b, bid->value)) return false;
+    } else if (!dynamic_cast<NumberExp*>(cond->right)) {
+        return false;
+    }
+
+    // todas las escrituras de iv son incrementos del nivel superior
+    int increments = 0;
+    for (auto s : w->b->StmList) {
+        if (isIncrementOf(s, iv->value)) { increments++; continue; }
+        if (stmWritesVar(s, iv->value)) return false;
+    }
+    if (increments == 0) return false;
+
+    info.iv         = iv->value;
+    info.condOffset = k;
+    info.bound      = cond->right;
+    info.arrays.clear();
+    int indexUses = 0;
+    collectIndexed(w->b, iv->value, info.arrays, indexUses);
+    info.readsInLoop   = 1 + countVarReads(w->b, iv->value);
+    info.ivOnlyIndexes = info.readsInLoop == 1 + increments + indexUses;
+    return true;
+}
+
+// ----------------- Implementación de LoopOptimizer -----------------
+
+void LoopOptimizer::optimize(Program* p) {
+    if (!p) return;
+    for (auto f : p->fdlist) {
+        optimizeFunction(f->cuerpo, f->Pnombres);
+    }
+    for (auto impl : p->impls) {
+        optimizeFunction(impl->body, {impl->paramName});
+    }
+}
+
+void LoopOptimizer::optimizeFunction(Body* cuerpo, const vector<string>& params) {
+    if (!cuerpo) return;
+    locals.clear();
+    for (auto &p : params) locals.insert(p);
+    collectLets(cuerpo, locals);
+
+    // valores iniciales conocidos de los let del nivel superior
+    unordered_map<string, Exp*> letInits;
+    for (auto v : cuerpo->vars) {
+        if (dynamic_cast<NumberExp*>(v->e)) letInits[v->id] = v->e;
+    }
+    optimizeBody(cuerpo, &letInits);
+}
+
+void LoopOptimizer::optimizeBody(Body* b, const unordered_map<string, Exp*>* letInits) {
+    if (!b) return;
+
+    std::list<Stm*> result;
+    for (auto s : b->StmList) {
+        if (auto ifs = dynamic_cast<IfStm*>(s)) {
+            optimizeBody(ifs->then, nullptr);
+            optimizeBody(ifs->els, nullptr);
+        }
+        if (auto m = dynamic_cast<MatchStm*>(s)) {
+            for (auto arm : m->arms) optimizeBody(arm->body, nullptr);
+            optimizeBody(m->otherwise, nullptr);
+        }
+
+        auto w = dynamic_cast<WhileStm*>(s);
+        if (!w) {
+            result.push_back(s);
+            continue;
+        }
+
+        // primero los bucles internos
+        optimizeBody(w->b, nullptr);
+
+        // los bucles vectorizables se dejan enteros para el generador de código
+        ElementwiseLoop ew;
+        if (matchElementwiseLoop(w, locals, ew)) {
+            result.push_back(s);
+            continue;
+        }
+
+        CountedLoop info;
+        if (!matchCountedLoop(w, locals, info)) {
+            result.push_back(s);
+            continue;
+        }
+
+        // número de iteraciones, si iv y bound son constantes a la entrada
+        long long tripCount = -1;
+        auto boundNum = dynamic_cast<NumberExp*>(info.bound);
+        if (boundNum) {
+            Exp* init = nullptr;
+            bool found = false;
+            for (auto it = result.rbegin(); it != result.rend(); ++it) {
+                if (!stmWritesVar(*it, info.iv)) continue;
+                found = true;
+                auto a = dynamic_cast<AssignStm*>(*it);
+                if (a && dynamic_cast<IdExp*>(a->lhs)) init = a->e;
+                break;
+            }
+            if (!found && letInits && letInits->count(info.iv)) {
+                init = letInits->at(info.iv);
+            }
+            if (auto n0 = dynamic_cast<NumberExp*>(init)) {
+                long long span = (long long)boundNum->value - n0->value;
+                tripCount = span > 0 ? (span + info.step - 1) / info.step : 0;
+            }
+        }
+
+        if (!unroll(w, info, tripCount, result)) {
+            result.push_back(s);
+        }
+    }
+    b->StmList = result;
+}
+
+bool LoopOptimizer::unroll(WhileStm* w, const CountedLoop& info, long long tripCount,
+                           std::list<Stm*>& outList) {
+    int size = countNodes(w->b);
+
+    // desenrollado completo: el bucle desaparece
+    if (tripCount >= 0 && tripCount <= maxFullTrip && tripCount * size <= sizeBudget) {
+        for (long long k = 0; k < tripCount; ++k) {
+            for (auto s : w->b->StmList) outList.push_back(cloneStm(s));
+        }
+        return true;
+    }
+
+    int k = unrollFactor;
+    if (k < 2 || size * k > sizeBudget) return false;
+    if (tripCount >= 0 && tripCount < k) return false;
+
+    // bucle principal: k copias del cuerpo mientras queden k iteraciones
+    Body* mainBody = new Body();
+    for (int c = 0; c < k; ++c) {
+        for (auto s : w->b->StmList) mainBody->StmList.push_back(cloneStm(s));
+    }
+    IdExp* ivRef = new IdExp(info.iv);
+    ivRef->ty = "i64";
+    NumberExp* ahead = new NumberExp((k - 1) * info.step);
+    ahead->ty = "i64";
+    Exp* guard = makeBinary(ivRef, ahead, PLUS_OP);
+    Exp* cond  = makeBinary(guard, cloneExp(info.bound), LT_OP);
+    outList.push_back(new WhileStm(cond, mainBody));
+
+    // epílogo: el bucle original consume el resto (menos de k iteraciones)
+    if (tripCount < 0 || tripCount % k != 0) {
+        outList.push_back(w);
+    }
+    return true;
+}
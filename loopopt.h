@@ -0,0 +1,67 @@
+#ifndef LOOPOPT_H
+#define LOOPOPT_H
+
+#include "ast.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Bucle contado: while (iv < bound) { ...; iv = iv + step }
+struct CountedLoop {
+    std::string iv;
+    Exp* bound = nullptr;
+    int step = 1;
+};
+
+bool matchCountedLoop(WhileStm* w, const std::unordered_set<std::string>& locals,
+                      CountedLoop& info);
+
+// Bucle elemento a elemento sobre arrays de i64, sin dependencias entre iteraciones:
+//   while (i < n) { c[i] = x op y; i = i + 1 }   con x, y = a[i] | constante
+struct ElementwiseLoop {
+    std::string iv;
+    Exp* bound = nullptr;
+    IdExp* dst = nullptr;
+    Exp* left  = nullptr;    // IdExp del array o NumberExp
+    Exp* right = nullptr;
+    BinaryOp op = PLUS_OP;
+};
+
+bool matchElementwiseLoop(WhileStm* w, const std::unordered_set<std::string>& locals,
+                          ElementwiseLoop& info);
+
+// Bucle con variable de inducción: while (iv [+ k] < bound) { ... iv = iv + c ... }
+// donde todas las escrituras de iv son incrementos en el nivel superior del cuerpo.
+struct InductionLoop {
+    std::string iv;
+    int condOffset = 0;                 // k en (iv + k < bound)
+    Exp* bound = nullptr;
+    std::vector<std::string> arrays;    // arrays accedidos como a[iv]
+    int readsInLoop = 0;                // lecturas de iv en condición y cuerpo
+    bool ivOnlyIndexes = false;         // iv solo aparece como índice, en la condición
+                                        // y en sus propios incrementos
+};
+
+bool matchInductionLoop(WhileStm* w, const std::unordered_set<std::string>& locals,
+                        InductionLoop& info);
+int countVarReads(Body* b, const std::string& name);
+int countNodes(Body* b);                  // tamaño del cuerpo en nodos del AST
+
+class LoopOptimizer {
+public:
+    int unrollFactor = 4;    // factor del desenrollado parcial
+    int maxFullTrip  = 8;    // máximo de iteraciones para desenrollar por completo
+    int sizeBudget   = 96;   // máximo de nodos del cuerpo ya desenrollado
+
+    void optimize(Program* p);
+
+private:
+    std::unordered_set<std::string> locals;
+
+    void optimizeFunction(Body* cuerpo, const std::vector<std::string>& params);
+    void optimizeBody(Body* b, const std::unordered_map<std::string, Exp*>* letInits);
+    bool unroll(WhileStm* w, const CountedLoop& info, long long tripCount,
+                std::list<Stm*>& outList);
+};
+
+#endif
@@ -10,6 +10,14 @@
 #include "peephole.h"
 #include "dag.h"   
 #include "typechecker.h"
+#include "loopopt.h"
+#include "inliner.h"
+#include "opfusion.h"
+#include "sra.h"
+#include "soa.h"
+#include "statics.h"
+#include "callgraph.h"
+#include "icf.h"
 
 using namespace std;
 
@@ -48,6 +56,26 @@ int main(int argc, const char* argv[]) {
     TypeChecker tc;
     tc.checkProgram(program);
 
+    StaticFolding staticFolding;
+    staticFolding.optimize(program);
+
+    OpFusion opFusion;
+    opFusion.optimize(program);
+
+    Inliner inliner;
+    inliner.optimize(program);
+
+    StructOfArrays soa;
+    soa.optimize(program);
+
+    ScalarReplacement sra;
+    sra.optimize(program);
+
+    LoopOptimizer loopOpt;
+    loopOpt.optimize(program);
+
+    CallGraph callGraph;
+    callGraph.optimize(program);
 
     // DAGOptimizer dagOpt;
     // dagOpt.optimize(program);
@@ -64,8 +92,12 @@ int main(int argc, const char* argv[]) {
     }
 
     cout << "Generando codigo ensamblador en " << outputFilename << endl;
-    GenCodeVisitor codigo(outfile);
+    std::ostringstream asmBuffer;
+    GenCodeVisitor codigo(asmBuffer);
     codigo.generar(program);
+
+    // funciones con el mismo código: una sola copia y alias para el resto
+    outfile << IdenticalCodeFolding::optimize(asmBuffer.str());
     outfile.close();
     
     return 0;
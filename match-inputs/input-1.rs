@@ -0,0 +1,21 @@
+fn dense(op: i64) -> i64 {
+    let r: i64 = 0;
+    match (op) {
+        0 => { r = 10 }
+        1 => { r = 11 }
+        2 => { r = 12 }
+        3 => { r = 13 }
+        4 | 5 => { r = 45 }
+        6 => { r = 16 }
+        _ => { r = 0 - 1 }
+    }
+    return(r);
+}
+
+fn main() {
+    let i: i64 = 0 - 2;
+    while (i < 10) {
+        println!("{}", dense(i));
+        i = i + 1;
+    }
+}
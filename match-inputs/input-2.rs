@@ -0,0 +1,24 @@
+fn sparse(x: i64) -> i64 {
+    let r: i64 = 0;
+    match (x) {
+        1 => { r = 1 }
+        100 => { r = 2 }
+        1000..=1999 => { r = 3 }
+        5000 => { r = 4 }
+        -7 => { r = 5 }
+        70000 => { r = 6 }
+        _ => { r = 9 }
+    }
+    return(r);
+}
+
+fn main() {
+    println!("{}", sparse(1));
+    println!("{}", sparse(100));
+    println!("{}", sparse(1500));
+    println!("{}", sparse(2000));
+    println!("{}", sparse(5000));
+    println!("{}", sparse(0 - 7));
+    println!("{}", sparse(70000));
+    println!("{}", sparse(3));
+}
@@ -0,0 +1,22 @@
+fn small(c: i64) -> i64 {
+    match (c) {
+        1 | 3 | 5 | 7 | 9 => { return(1) }
+        2 | 4 | 8 => { return(2) }
+        _ => { return(0) }
+    }
+    return(0 - 1);
+}
+
+fn main() {
+    let i: i64 = 0;
+    let s: i64 = 0;
+    while (i < 12) {
+        s = s * 10 + small(i);
+        i = i + 1;
+    }
+    println!("{}", s);
+    match (s) {
+        0..10 => { println!("{}", 111); }
+        _ => { println!("{}", 222); }
+    }
+}
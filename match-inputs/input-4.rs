@@ -0,0 +1,40 @@
+fn wide(x: i64) -> i64 {
+    let r: i64 = 0;
+    match (x) {
+        -9223372036854775808..=-5000000000 => { r = 1 }
+        5000000000 => { r = 2 }
+        9223372036854775807 => { r = 3 }
+        0..3 => { r = 4 }
+        _ => { r = 5 }
+    }
+    return(r);
+}
+
+fn far(x: i64) -> i64 {
+    let r: i64 = 0;
+    match (x) {
+        7000000000 => { r = 10 }
+        7000000001 => { r = 11 }
+        7000000002 => { r = 12 }
+        7000000003 => { r = 13 }
+        7000000004 | 7000000005 => { r = 45 }
+        _ => { r = 0 }
+    }
+    return(r);
+}
+
+fn main() {
+    let m: i64 = 0 - 9223372036854775807 - 1;
+    println!("{}", wide(m));
+    println!("{}", wide(0 - 5000000000));
+    println!("{}", wide(0 - 4999999999));
+    println!("{}", wide(5000000000));
+    println!("{}", wide(9223372036854775807));
+    println!("{}", wide(2));
+    println!("{}", wide(3));
+    let i: i64 = 6999999999;
+    while (i < 7000000007) {
+        println!("{}", far(i));
+        i = i + 1;
+    }
+}
@@ -0,0 +1,35 @@
+struct Pixel {
+    r: u8,
+    g: u8,
+    b: u8,
+    alpha: i32,
+}
+
+fn brighten(c: u8, k: u8) -> u8 {
+    return(c + k);
+}
+
+fn main() {
+    let x: u8 = 250;
+    x = x + 10;
+    println!("{}", x);
+
+    let big: u32 = 4000000000;
+    big = big + 500000000;
+    println!("{}", big);
+
+    let s: i32 = 2147483647;
+    s = s + 1;
+    println!("{}", s);
+
+    let p: Pixel = Pixel { r: 200, g: 100, b: 50, alpha: 0 - 7 };
+    p.r = brighten(p.r, 100);
+    p.alpha = p.alpha * 3;
+    println!("{}", p.r);
+    println!("{}", p.alpha);
+
+    let w: i64 = 300;
+    println!("{}", w as u8);
+    println!("{}", (0 - 1) as u32);
+    println!("{}", (s as i64) - 1);
+}
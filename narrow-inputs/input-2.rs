@@ -0,0 +1,32 @@
+fn main() {
+    let bytes: [u8; 8] = [1, 2, 3, 4, 5, 6, 7, 255];
+    let words: [i32; 6] = [10, 0 - 20, 30, 0 - 40, 50, 2000000000];
+    let flags: [bool; 4] = [true, false, true, true];
+
+    let i: i64 = 0;
+    let sum: i64 = 0;
+    while (i < 8) {
+        sum = sum + (bytes[i] as i64);
+        bytes[i] = bytes[i] * 2;
+        i = i + 1;
+    }
+    println!("{}", sum);
+    println!("{}", bytes[7]);
+    println!("{}", bytes[3]);
+
+    let j: i64 = 0;
+    let acc: i32 = 0;
+    while (j < 6) {
+        acc = acc + words[j];
+        j = j + 1;
+    }
+    println!("{}", acc);
+
+    let k: u8 = 0;
+    let set: i64 = 0;
+    while (k < 4) {
+        set = set + flags[k];
+        k = k + 1;
+    }
+    println!("{}", set);
+}
@@ -0,0 +1,276 @@
+#include "opfusion.h"
+#include "visitor.h"
+#include <unordered_set>
+#include <vector>
+
+using std::string;
+using std::unordered_map;
+using std::unordered_set;
+using std::vector;
+
+// ----------------- Helpers -----------------
+
+static int size(Exp* e) {
+    if (auto b = dynamic_cast<BinaryExp*>(e))       return 1 + size(b->left) + size(b->right);
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return 1 + size(fa->base);
+    if (auto ix = dynamic_cast<IndexExp*>(e))       return 1 + size(ix->array) + size(ix->index);
+    if (auto c = dynamic_cast<CastExp*>(e))         return 1 + size(c->e);
+    return 1;
+}
+
+// hoja de una cadena: un struct accesible sin efectos (p, seg.a, pts[i])
+static bool isPurePath(Exp* e) {
+    if (dynamic_cast<IdExp*>(e)) return true;
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return isPurePath(fa->base);
+    if (auto ix = dynamic_cast<IndexExp*>(e))       return isPurePath(ix->array) && isPure(ix->index);
+    return false;
+}
+
+static bool isScalarField(const string& structName, const string& field) {
+    auto it = structTable.find(structName);
+    if (it == structTable.end() || !it->second.fieldType.count(field)) return false;
+    return it->second.fieldType[field] == "i64";
+}
+
+// expresión de un campo del resultado: aritmética sobre self.g, other.h y constantes
+static bool isFieldwiseExp(Exp* e, const string& type, const string& param) {
+    if (dynamic_cast<NumberExp*>(e)) return true;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        return !b->hasOverloadedImpl && b->op != LT_OP &&
+               isFieldwiseExp(b->left, type, param) && isFieldwiseExp(b->right, type, param);
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        auto id = dynamic_cast<IdExp*>(fa->base);
+        return id && (id->value == "self" || id->value == param) && isScalarField(type, fa->field);
+    }
+    return false;
+}
+
+// campos de `root` leídos por la expresión; `whole` si se usa root entero
+static void rootReads(Exp* e, const string& root, unordered_set<string>& fields, bool& whole) {
+    if (!e) return;
+    if (auto id = dynamic_cast<IdExp*>(e)) {
+        if (id->value == root) whole = true;
+        return;
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        auto id = dynamic_cast<IdExp*>(fa->base);
+        if (id && id->value == root) fields.insert(fa->field);
+        else rootReads(fa->base, root, fields, whole);
+        return;
+    }
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        rootReads(b->left, root, fields, whole);
+        rootReads(b->right, root, fields, whole);
+    }
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        rootReads(ix->array, root, fields, whole);
+        rootReads(ix->index, root, fields, whole);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) rootReads(c->e, root, fields, whole);
+}
+
+static string rootName(Exp* e) {
+    while (true) {
+        if (auto fa = dynamic_cast<FieldAccessExp*>(e)) e = fa->base;
+        else if (auto ix = dynamic_cast<IndexExp*>(e)) e = ix->array;
+        else break;
+    }
+    auto id = dynamic_cast<IdExp*>(e);
+    return id ? id->value : "";
+}
+
+// ----------------- OpFusion -----------------
+
+void OpFusion::optimize(Program* p) {
+    if (!p) return;
+
+    for (auto impl : p->impls) {
+        string name = opImplName(impl);
+        if (name.empty()) continue;
+
+        const string& t = impl->typeName;
+        if (impl->paramType != t || impl->returnType != t || !structTable.count(t)) continue;
+
+        // cuerpo: `let r: T = T {...}; return r`  o  `return T {...}`
+        Body* b = impl->body;
+        StructLitExp* lit = nullptr;
+        if (b->StmList.size() != 1) continue;
+        auto ret = dynamic_cast<ReturnStm*>(b->StmList.front());
+        if (!ret) continue;
+        if (b->vars.empty()) {
+            lit = dynamic_cast<StructLitExp*>(ret->e);
+        } else if (b->vars.size() == 1) {
+            LetStm* let = b->vars.front();
+            auto rid = dynamic_cast<IdExp*>(ret->e);
+            if (rid && rid->value == let->id && let->type == t) {
+                lit = dynamic_cast<StructLitExp*>(let->e);
+            }
+        }
+        if (!lit || lit->nombre != t) continue;
+
+        FieldwiseOp op;
+        op.type  = t;
+        op.param = impl->paramName;
+        bool ok = true;
+        for (auto &f : lit->fields) {
+            ok = ok && isScalarField(t, f.first) && isFieldwiseExp(f.second, t, op.param);
+            op.fields[f.first] = f.second;
+        }
+        for (auto &fname : structTable[t].fieldOrder) ok = ok && op.fields.count(fname);
+        if (!ok) continue;
+
+        ops[name] = op;
+    }
+    if (ops.empty()) return;
+
+    for (auto f : p->fdlist) rewriteBody(f->cuerpo);
+    for (auto impl : p->impls) rewriteBody(impl->body);
+}
+
+// ¿es `e` una cadena de operadores campo a campo sobre hojas sin efectos?
+bool OpFusion::fusable(Exp* e) {
+    auto b = dynamic_cast<BinaryExp*>(e);
+    if (!b || !b->hasOverloadedImpl || !ops.count(b->implFuncName)) return false;
+    auto operand = [&](Exp* x) { return isPurePath(x) || fusable(x); };
+    return operand(b->left) && operand(b->right);
+}
+
+// expresión escalar del campo `field` del valor de `e` (cadena u hoja)
+Exp* OpFusion::fuseField(Exp* e, const string& field) {
+    auto b = dynamic_cast<BinaryExp*>(e);
+    if (b && b->hasOverloadedImpl) {
+        const FieldwiseOp& op = ops[b->implFuncName];
+        return instantiate(op.fields.at(field), op, b->left, b->right);
+    }
+    FieldAccessExp* fa = new FieldAccessExp(cloneExp(e), field);
+    fa->ty = structTable[e->ty].fieldType[field];
+    return fa;
+}
+
+Exp* OpFusion::instantiate(Exp* x, const FieldwiseOp& op, Exp* self, Exp* other) {
+    if (auto fa = dynamic_cast<FieldAccessExp*>(x)) {
+        auto id = static_cast<IdExp*>(fa->base);
+        return fuseField(id->value == "self" ? self : other, fa->field);
+    }
+    if (auto b = dynamic_cast<BinaryExp*>(x)) {
+        BinaryExp* nb = new BinaryExp(instantiate(b->left, op, self, other),
+                                      instantiate(b->right, op, self, other), b->op);
+        nb->hasOverloadedImpl = false;
+        nb->ty = "i64";
+        return nb;
+    }
+    return cloneExp(x);
+}
+
+// literal T { f: ... } con la cadena entera, o nullptr si algún campo crece demasiado
+Exp* OpFusion::fuseStruct(Exp* e) {
+    const string& t = e->ty;
+    StructLitExp* lit = new StructLitExp();
+    lit->nombre = t;
+    lit->ty = t;
+    for (auto &fname : structTable[t].fieldOrder) {
+        Exp* fe = fuseField(e, fname);
+        if (size(fe) > maxFieldNodes) return nullptr;
+        lit->fields.push_back({fname, fe});
+    }
+    return lit;
+}
+
+void OpFusion::rewriteBody(Body* b) {
+    if (!b) return;
+
+    for (auto v : b->vars) {
+        if (!v->e) continue;
+        if (fusable(v->e)) {
+            if (Exp* lit = fuseStruct(v->e)) {
+                v->e = lit;
+                continue;
+            }
+        }
+        v->e = rewrite(v->e);
+    }
+
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            a->lhs = rewrite(a->lhs);
+            StructLitExp* lit = fusable(a->e) ? static_cast<StructLitExp*>(fuseStruct(a->e)) : nullptr;
+            if (!lit) {
+                a->e = rewrite(a->e);
+                continue;
+            }
+
+            // El literal se guarda campo a campo en el destino: ningún campo puede
+            // leer otro del destino que ya se haya escrito antes (en orden de declaración).
+            bool hazard = false;
+            string root = rootName(a->lhs);
+            if (auto id = dynamic_cast<IdExp*>(a->lhs)) {
+                unordered_set<string> written;
+                for (auto &f : lit->fields) {
+                    unordered_set<string> reads;
+                    bool whole = false;
+                    rootReads(f.second, id->value, reads, whole);
+                    for (auto &r : reads) hazard = hazard || written.count(r);
+                    hazard = hazard || whole;
+                    written.insert(f.first);
+                }
+            } else {
+                for (auto &f : lit->fields) {
+                    unordered_set<string> reads;
+                    bool whole = false;
+                    rootReads(f.second, root, reads, whole);
+                    hazard = hazard || whole || !reads.empty();
+                }
+            }
+            if (!hazard) a->e = lit;
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  p->e = rewrite(p->e);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) r->e = rewrite(r->e);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            i->condition = rewrite(i->condition);
+            rewriteBody(i->then);
+            rewriteBody(i->els);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            w->condition = rewrite(w->condition);
+            rewriteBody(w->b);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            m->scrutinee = rewrite(m->scrutinee);
+            for (auto arm : m->arms) rewriteBody(arm->body);
+            rewriteBody(m->otherwise);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) rewrite(fs->call);
+    }
+}
+
+// (cadena).campo dentro de cualquier expresión -> expresión escalar fusionada
+Exp* OpFusion::rewrite(Exp* e) {
+    if (!e) return e;
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        if (fusable(fa->base)) {
+            Exp* fe = fuseField(fa->base, fa->field);
+            if (size(fe) <= maxFieldNodes) return fe;
+        }
+        fa->base = rewrite(fa->base);
+    }
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        b->left  = rewrite(b->left);
+        b->right = rewrite(b->right);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto &a : f->argumentos) a = rewrite(a);
+    }
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        ix->array = rewrite(ix->array);
+        ix->index = rewrite(ix->index);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) f.second = rewrite(f.second);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto &x : al->elems) x = rewrite(x);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) c->e = rewrite(c->e);
+    return e;
+}
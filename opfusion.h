@@ -0,0 +1,36 @@
+#ifndef OPFUSION_H
+#define OPFUSION_H
+
+#include "ast.h"
+#include <string>
+#include <unordered_map>
+
+// Fusión de cadenas de operadores sobrecargados sobre structs (p1 + p2 + p3).
+// Si el cuerpo de cada operador es un literal campo a campo, la cadena entera se
+// reescribe como un único StructLit (o, en c.x, como la expresión de ese campo),
+// sin llamadas a __op_* ni structs intermedios.
+class OpFusion {
+public:
+    int maxFieldNodes = 64;    // tamaño máximo de la expresión fusionada de un campo
+
+    void optimize(Program* p);
+
+private:
+    // operador cuyo resultado es T { f: expr(self.g, other.h, constantes), ... }
+    struct FieldwiseOp {
+        std::string type;
+        std::string param;                             // nombre de `other`
+        std::unordered_map<std::string, Exp*> fields;  // campo -> expresión
+    };
+    std::unordered_map<std::string, FieldwiseOp> ops;  // __op_* -> operador
+
+    bool fusable(Exp* e);
+    Exp* fuseField(Exp* e, const std::string& field);
+    Exp* instantiate(Exp* x, const FieldwiseOp& op, Exp* self, Exp* other);
+    Exp* fuseStruct(Exp* e);
+
+    void rewriteBody(Body* b);
+    Exp* rewrite(Exp* e);
+};
+
+#endif
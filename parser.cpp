@@ -1,4 +1,5 @@
 #include <iostream>
+#include <climits>
 #include "token.h"
 #include "scanner.h"
 #include "ast.h"
@@ -444,6 +445,54 @@ Stm* Parser::parseStm() {
         }
         a = new WhileStm(e, tb);
     }
+    else if (match(Token::MATCH)) {
+        // match (e) { 1 => {..} 2 | 5..=9 => {..} _ => {..} }
+        match(Token::LPAREN);
+        e = parseCE();
+        match(Token::RPAREN);
+        if (!match(Token::LBRACK)) {
+            throw runtime_error("Se esperaba '{' después de la expresión del match");
+        }
+        MatchStm* m = new MatchStm(e);
+        while (!check(Token::RBRACK) && !isAtEnd()) {
+            // el comodín cierra el match: un brazo detrás nunca se alcanzaría
+            if (m->otherwise) {
+                throw runtime_error(check(Token::UNDERSCORE) ? "Comodín '_' repetido en el match"
+                                                             : "Brazo del match después del comodín '_'");
+            }
+            MatchArm* arm = nullptr;
+            if (!match(Token::UNDERSCORE)) {
+                arm = new MatchArm(nullptr);
+                do {
+                    long long lo = parsePatternNum();
+                    long long hi = lo;
+                    if (match(Token::DOTDOTEQ)) hi = parsePatternNum();
+                    else if (match(Token::DOTDOT)) {
+                        hi = parsePatternNum();
+                        if (hi == LLONG_MIN) {
+                            throw runtime_error("Rango vacío en un brazo del match");
+                        }
+                        hi--;
+                    }
+                    arm->ranges.push_back({lo, hi});
+                } while (match(Token::BAR));
+            }
+            if (!match(Token::FATARROW) || !match(Token::LBRACK)) {
+                throw runtime_error("Se esperaba '=> {' en el brazo del match");
+            }
+            tb = parseBody();
+            match(Token::RBRACK);
+            match(Token::COMA);
+            if (arm) {
+                arm->body = tb;
+                m->arms.push_back(arm);
+            } else {
+                m->otherwise = tb ? tb : new Body();
+            }
+        }
+        match(Token::RBRACK);
+        a = m;
+    }
     else{
         if (check(Token::RBRACK)) return nullptr;
         throw runtime_error("Error sintáctico");
@@ -451,6 +500,25 @@ Stm* Parser::parseStm() {
     return a;
 }
 
+// literal entero (i64) de un patrón de match, con signo opcional
+long long Parser::parsePatternNum() {
+    bool neg = match(Token::MINUS);
+    if (!match(Token::NUM)) {
+        throw runtime_error("Se esperaba un literal entero en el patrón del match");
+    }
+    unsigned long long v = 0;
+    try {
+        v = stoull(previous->text);
+    } catch (const out_of_range&) {
+        v = ULLONG_MAX;
+    }
+    // -9223372036854775808 es el único valor cuyo módulo no cabe en i64
+    if (v > (unsigned long long)LLONG_MAX + (neg ? 1 : 0)) {
+        throw runtime_error("Literal fuera del rango de i64 en el patrón del match: " + previous->text);
+    }
+    return neg ? (long long)(0ULL - v) : (long long)v;
+}
+
 Exp* Parser::parseCE() {
     Exp* l = parseBE();
     if (match(Token::LT)) {
@@ -517,6 +585,9 @@ Exp* Parser::parseF() {
             match(Token::RCORCH);              // ']'
             e = new IndexExp(e, idx);
         }
+        else if (match(Token::AS)) {          // e as u8
+            e = new CastExp(e, parseType());
+        }
         else {
             break;
         }
@@ -529,7 +600,7 @@ Exp* Parser::parsePrimary() {
     Exp* e;
     string nom;
     if (match(Token::NUM)) {
-        return new NumberExp(stoi(previous->text));
+        return new NumberExp(stoll(previous->text));
     }
     else if (match(Token::STRING)) { 
         return new StringExp(previous->text);
@@ -25,6 +25,7 @@ public:
     void parseTypeAlias(ImplDec* );
     Stm* parseStm();
     Exp* parseCE();
+    long long parsePatternNum();
     Exp* parseBE();
     Exp* parseE();
     Exp* parseT();
@@ -0,0 +1,33 @@
+struct P {
+    x: i64,
+    y: i64,
+}
+
+fn mk(a: i64, b: i64) -> P {
+    if (a < 0) {
+        return(mk(0, b));
+    }
+    let p: P = P { x: a, y: b };
+    return(p);
+}
+
+fn fill(k: i64) -> [i64; 4] {
+    if (k < 0) {
+        return(fill(0));
+    }
+    return([k, k + 1, k * 2, mk(k, 7).y]);
+}
+
+fn main() {
+    let q: P = mk(3, 4);
+    let s: i64 = 0;
+    let i: i64 = 0;
+    let a: [i64; 4] = fill(1);
+    while (i < 1000000) {
+        a = fill(i);
+        s = s + a[3] + a[2] + fill(i)[1] + mk(i, 2).x;
+        i = i + 1;
+    }
+    println!("{}", q.x + q.y);
+    println!("{}", s);
+}
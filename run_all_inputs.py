@@ -13,6 +13,16 @@ programa = [
     "peephole.cpp", 
     "dag.cpp",
     "typechecker.cpp",
+    "loopopt.cpp",
+    "inliner.cpp",
+    "opfusion.cpp",
+    "isel.cpp",
+    "sra.cpp",
+    "soa.cpp",
+    "layout.cpp",
+    "statics.cpp",
+    "callgraph.cpp",
+    "icf.cpp",
 ]
 
 # Compilar
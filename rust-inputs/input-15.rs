@@ -0,0 +1,21 @@
+static mut CONTADOR: i64 = 0;
+
+fn bump(n: i64) -> i64 {
+    println!("{}", n);
+    CONTADOR = CONTADOR + 1;
+    return(n);
+}
+
+fn cuenta(n: i64) -> i64 {
+    let t: i64 = bump(n);
+    if (n < 1) {
+        return(0);
+    }
+    return(t * cuenta(n - 1) + 1);
+}
+
+fn main() {
+    println!("{}", cuenta(4));
+    println!("{}", CONTADOR);
+    return(0);
+}
@@ -0,0 +1,25 @@
+static mut G: i64 = 0;
+
+fn p(n: i64) -> i64 {
+    if (n < 0) {
+        return(p(0));
+    }
+    println!("{}", n);
+    return(n);
+}
+
+fn q(n: i64) -> i64 {
+    if (n < 0) {
+        return(q(0));
+    }
+    G = G + 135;
+    return(n);
+}
+
+fn main() {
+    G = 13;
+    println!("{}", p(1) - (p(2) * p(3) - p(4) * p(5)));
+    println!("{}", G - q(7));
+    println!("{}", G - (q(1) + q(2) * G));
+    return(0);
+}
@@ -0,0 +1,23 @@
+static mut C: i64 = 0;
+
+fn f(n: i64) -> i64 {
+    C = C + 1;
+    if (n < 1) {
+        return(0);
+    }
+    return(f(n - 1) + C);
+}
+
+fn g(n: i64) -> i64 {
+    if (n < 1) {
+        return(1);
+    }
+    return(g(n - 1) * n);
+}
+
+fn main() {
+    println!("{}", f(3));
+    println!("{}", C);
+    println!("{}", g(5));
+    return(0);
+}
@@ -82,8 +82,15 @@ Token* Scanner::nextToken() {
         else if (lexema=="type") return new Token(Token::TYPE, input, first, current - first);
         else if (lexema=="for") return new Token(Token::FOR, input, first, current - first);
         else if (lexema=="self") return new Token(Token::SELF, input, first, current - first);
+        else if (lexema=="match") return new Token(Token::MATCH, input, first, current - first);
+        else if (lexema=="as") return new Token(Token::AS, input, first, current - first);
 
         else return new Token(Token::ID, input, first, current - first);
+    }
+    // comodín `_` de los brazos de match
+    else if (c == '_' && (current + 1 >= input.length() || !isalnum(input[current + 1]))) {
+        current++;
+        token = new Token(Token::UNDERSCORE, c);
     }
         // --- Strings y el formato "{}" de println! ---
     else if (c == '"') {
@@ -139,7 +146,7 @@ Token* Scanner::nextToken() {
         }
     }
     // Operadores
-    else if (strchr("+/-*();=<:,{}.[]", c)) {
+    else if (strchr("+/-*();=<:,{}.[]|", c)) {
         switch (c) {
             case '<': token = new Token(Token::LT,  c); break;
             case '+': token = new Token(Token::PLUS,  c); break;
@@ -173,13 +180,37 @@ Token* Scanner::nextToken() {
             case '/': token = new Token(Token::DIV,   c); break;
             case '(': token = new Token(Token::LPAREN,c); break;
             case ')': token = new Token(Token::RPAREN,c); break;
-            case '=': token = new Token(Token::ASSIGN,c); break;
+            case '=':
+            if (input[current+1]=='>')
+            {
+                current++;
+                token = new Token(Token::FATARROW, input, first, current + 1 - first);
+            }
+            else{
+                token = new Token(Token::ASSIGN,c);
+            }
+            break;
             case ';': token = new Token(Token::SEMICOL,c); break;
             case ':': token = new Token(Token::COLON,c); break;
             case ',': token = new Token(Token::COMA,c); break;
             case '{': token = new Token(Token::LBRACK,c); break;
             case '}': token = new Token(Token::RBRACK,c); break;
-            case '.': token = new Token(Token::DOT,c); break;
+            case '.':
+            if (input[current+1]=='.')
+            {
+                current++;
+                if (input[current+1]=='=') {
+                    current++;
+                    token = new Token(Token::DOTDOTEQ, input, first, current + 1 - first);
+                } else {
+                    token = new Token(Token::DOTDOT, input, first, current + 1 - first);
+                }
+            }
+            else{
+                token = new Token(Token::DOT,c);
+            }
+            break;
+            case '|': token = new Token(Token::BAR,c); break;
             case '[': token = new Token(Token::LCORCH,c); break;
             case ']': token = new Token(Token::RCORCH,c); break;
 
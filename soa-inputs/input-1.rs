@@ -0,0 +1,48 @@
+struct Particle {
+    x: i64,
+    y: i64,
+    mass: i64,
+}
+
+fn main() {
+    let ps: [Particle; 16] = [
+        Particle { x: 1, y: 2, mass: 3 }, Particle { x: 4, y: 5, mass: 6 },
+        Particle { x: 7, y: 8, mass: 9 }, Particle { x: 10, y: 11, mass: 12 },
+        Particle { x: 13, y: 14, mass: 15 }, Particle { x: 16, y: 17, mass: 18 },
+        Particle { x: 19, y: 20, mass: 21 }, Particle { x: 22, y: 23, mass: 24 },
+        Particle { x: 25, y: 26, mass: 27 }, Particle { x: 28, y: 29, mass: 30 },
+        Particle { x: 31, y: 32, mass: 33 }, Particle { x: 34, y: 35, mass: 36 },
+        Particle { x: 37, y: 38, mass: 39 }, Particle { x: 40, y: 41, mass: 42 },
+        Particle { x: 43, y: 44, mass: 45 }, Particle { mass: 48, x: 46, y: 47 }
+    ];
+
+    let i: i64 = 0;
+    while (i < 16) {
+        ps[i].x = ps[i].x + 100;
+        i = i + 1;
+    }
+
+    let sum: i64 = 0;
+    let j: i64 = 0;
+    while (j < 16) {
+        sum = sum + ps[j].x;
+        j = j + 1;
+    }
+    println!("{}", sum);
+
+    ps[0] = ps[15];
+    ps[1] = Particle { x: 0 - 1, y: 8, mass: 0 };
+    let p: Particle = ps[3];
+    println!("{}", ps[0].x);
+    println!("{}", ps[0].mass);
+    println!("{}", ps[1].x + ps[1].y);
+    println!("{}", p.x + p.y + p.mass);
+
+    let k: i64 = 0;
+    let energy: i64 = 0;
+    while (k < 16) {
+        energy = energy + ps[k].mass * ps[k].y;
+        k = k + 1;
+    }
+    println!("{}", energy);
+}
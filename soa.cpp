@@ -0,0 +1,370 @@
+#include "soa.h"
+#include "visitor.h"
+
+using std::list;
+using std::pair;
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+// ----------------- Helpers -----------------
+
+// struct accesible sin efectos (q, s.p, qs[j]); ningún índice lee `var`
+static bool purePathAvoiding(Exp* e, const string& var) {
+    if (dynamic_cast<IdExp*>(e)) return true;
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return purePathAvoiding(fa->base, var);
+    if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        return isPure(ix->index) && !mentions(ix->index, var) && purePathAvoiding(ix->array, var);
+    }
+    return false;
+}
+
+// ----------------- Candidatos -----------------
+
+bool StructOfArrays::transformable(LetStm* v, Layout& lay) {
+    string elem;
+    int len;
+    if (!isArrayType(v->type)) return false;
+    parseArrayType(v->type, elem, len);
+    if (len < minLength) return false;
+    auto st = structTable.find(elem);
+    if (st == structTable.end()) return false;
+
+    lay.structName = elem;
+    lay.length = len;
+    for (auto& f : st->second.fieldOrder) {
+        string t = st->second.fieldType[f];
+        if (isAggregateType(t)) return false;
+        lay.fields.push_back(f);
+        lay.arrays[f] = "__soa_" + v->id + "_" + f;
+        lay.types[f] = t;
+    }
+    if (lay.fields.empty()) return false;
+
+    // el literal se reparte por campos: sus elementos no pueden tener efectos
+    if (!v->e) return true;
+    auto al = dynamic_cast<ArrayLitExp*>(v->e);
+    if (!al || (int)al->elems.size() != len) return false;
+    for (auto x : al->elems) {
+        auto sl = dynamic_cast<StructLitExp*>(x);
+        if (!sl || sl->nombre != elem || !isPure(sl)) return false;
+    }
+    return true;
+}
+
+// pts[i] sobre un array transformado
+IndexExp* StructOfArrays::soaElement(Exp* e) {
+    auto ix = dynamic_cast<IndexExp*>(e);
+    if (!ix) return nullptr;
+    auto id = dynamic_cast<IdExp*>(ix->array);
+    return id && soas.count(id->value) ? ix : nullptr;
+}
+
+// pts[i] = P { ... } o pts[i] = q: se escribe campo a campo, así que ni el
+// índice ni el valor pueden depender de lo que se va escribiendo
+bool StructOfArrays::elementStore(AssignStm* a) {
+    IndexExp* dst = soaElement(a->lhs);
+    if (!dst) return false;
+    const string& var = static_cast<IdExp*>(dst->array)->value;
+    if (!isPure(dst->index) || mentions(dst->index, var)) return false;
+    if (auto sl = dynamic_cast<StructLitExp*>(a->e)) return isPure(sl) && !mentions(sl, var);
+    return purePathAvoiding(a->e, var);
+}
+
+// lectura de un elemento entero: let p: P = pts[i] o q = pts[i]
+static bool wholeRead(IndexExp* ix) {
+    return ix && isPure(ix->index);
+}
+
+// campo leído o escrito dentro del bucle en curso ("" = el elemento entero)
+void StructOfArrays::touch(IndexExp* element, const string& field) {
+    if (!loopFields) return;
+    const string& var = static_cast<IdExp*>(element->array)->value;
+    auto& used = (*loopFields)[var];
+    if (!field.empty()) used.insert(field);
+    else used.insert(soas[var].fields.begin(), soas[var].fields.end());
+}
+
+// descarta los arrays que se usan enteros o cuyos elementos salen de las formas anteriores
+void StructOfArrays::checkExp(Exp* e) {
+    if (!e) return;
+    if (auto id = dynamic_cast<IdExp*>(e)) {
+        soas.erase(id->value);
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        if (IndexExp* ix = soaElement(fa->base)) {
+            touch(ix, fa->field);
+            checkExp(ix->index);
+            return;
+        }
+        checkExp(fa->base);
+    }
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        checkExp(ix->array);
+        checkExp(ix->index);
+    }
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        checkExp(b->left);
+        checkExp(b->right);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : f->argumentos) checkExp(a);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) checkExp(f.second);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) checkExp(x);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) checkExp(c->e);
+}
+
+void StructOfArrays::checkBody(Body* b) {
+    if (!b) return;
+    for (auto v : b->vars) {
+        IndexExp* src = soaElement(v->e);
+        if (wholeRead(src)) {
+            touch(src, "");
+            checkExp(src->index);
+        }
+        else checkExp(v->e);
+    }
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            auto l = dynamic_cast<IdExp*>(a->lhs);
+            auto r = dynamic_cast<IdExp*>(a->e);
+            if (l && r && soas.count(l->value) && soas.count(r->value) && l->ty == r->ty) {
+                copies.push_back({l->value, r->value});      // copia entre arrays: campo a campo
+                continue;
+            }
+            IndexExp* dst = elementStore(a) ? soaElement(a->lhs) : nullptr;
+            if (dst) {
+                touch(dst, "");
+                checkExp(dst->index);
+            }
+            else checkExp(a->lhs);
+            IndexExp* src = soaElement(a->e);
+            if (wholeRead(src)) {
+                touch(src, "");
+                checkExp(src->index);
+            }
+            else checkExp(a->e);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  checkExp(p->e);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) checkExp(r->e);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            checkExp(i->condition);
+            checkBody(i->then);
+            checkBody(i->els);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            auto outer = loopFields;
+            unordered_map<string, std::set<string>> used;
+            loopFields = &used;
+            checkExp(w->condition);
+            checkBody(w->b);
+            loopFields = outer;
+            for (auto& u : used) {
+                if (soas.count(u.first) && u.second.size() < soas[u.first].fields.size()) {
+                    profitable.insert(u.first);
+                }
+                if (outer) (*outer)[u.first].insert(u.second.begin(), u.second.end());
+            }
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            checkExp(m->scrutinee);
+            for (auto arm : m->arms) checkBody(arm->body);
+            checkBody(m->otherwise);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) checkExp(fs->call);
+    }
+}
+
+// ----------------- Reescritura -----------------
+
+// __soa_pts_f[index]
+Exp* StructOfArrays::fieldArray(const string& var, const string& field, Exp* index) {
+    Layout& lay = soas[var];
+    IdExp* arr = new IdExp(lay.arrays[field]);
+    arr->ty = "[" + lay.types[field] + ";" + std::to_string(lay.length) + "]";
+    IndexExp* ix = new IndexExp(arr, index);
+    ix->ty = lay.types[field];
+    return ix;
+}
+
+// campo `field` de un valor de struct: del literal (los omitidos valen 0) o leído del camino
+Exp* StructOfArrays::fieldValue(Exp* e, const string& field, const string& structName) {
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) {
+            if (f.first == field) return rewrite(f.second);
+        }
+        return new NumberExp(0);
+    }
+    FieldAccessExp* fa = new FieldAccessExp(cloneExp(e), field);
+    fa->ty = structTable[structName].fieldType[field];
+    return rewrite(fa);
+}
+
+Exp* StructOfArrays::rewrite(Exp* e) {
+    if (!e) return e;
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        if (IndexExp* ix = soaElement(fa->base)) {
+            return fieldArray(static_cast<IdExp*>(ix->array)->value, fa->field, rewrite(ix->index));
+        }
+        fa->base = rewrite(fa->base);
+    }
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        if (soaElement(ix)) {
+            // elemento entero: P { x: __soa_pts_x[i], ... }
+            const string& var = static_cast<IdExp*>(ix->array)->value;
+            Layout& lay = soas[var];
+            Exp* index = rewrite(ix->index);
+            StructLitExp* sl = new StructLitExp();
+            sl->nombre = lay.structName;
+            sl->ty = lay.structName;
+            for (auto& f : lay.fields) sl->fields.push_back({f, fieldArray(var, f, cloneExp(index))});
+            return sl;
+        }
+        ix->array = rewrite(ix->array);
+        ix->index = rewrite(ix->index);
+    }
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        b->left  = rewrite(b->left);
+        b->right = rewrite(b->right);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto &a : f->argumentos) a = rewrite(a);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) f.second = rewrite(f.second);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto &x : al->elems) x = rewrite(x);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) c->e = rewrite(c->e);
+    return e;
+}
+
+void StructOfArrays::rewriteBody(Body* b, bool top) {
+    if (!b) return;
+
+    list<LetStm*> vars;
+    for (auto v : b->vars) {
+        if (top && soas.count(v->id)) {
+            // un let por campo; el literal [P { .. }, P { .. }] se reparte por columnas
+            Layout& lay = soas[v->id];
+            auto al = dynamic_cast<ArrayLitExp*>(v->e);
+            for (auto& f : lay.fields) {
+                Exp* init = nullptr;
+                string t = "[" + lay.types[f] + ";" + std::to_string(lay.length) + "]";
+                if (al) {
+                    vector<Exp*> col;
+                    for (auto x : al->elems) col.push_back(fieldValue(x, f, lay.structName));
+                    init = new ArrayLitExp(col);
+                    init->ty = t;
+                }
+                vars.push_back(new LetStm(lay.arrays[f], t, init, true));
+            }
+            continue;
+        }
+        v->e = rewrite(v->e);
+        vars.push_back(v);
+    }
+    b->vars = vars;
+
+    for (auto it = b->StmList.begin(); it != b->StmList.end(); ++it) {
+        Stm* s = *it;
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            auto l = dynamic_cast<IdExp*>(a->lhs);
+            auto r = dynamic_cast<IdExp*>(a->e);
+            if (l && r && soas.count(l->value) && soas.count(r->value)) {
+                // qs = pts: una copia por campo
+                Layout& lay = soas[l->value];
+                for (auto& f : lay.fields) {
+                    string t = "[" + lay.types[f] + ";" + std::to_string(lay.length) + "]";
+                    IdExp* dst = new IdExp(lay.arrays[f]);
+                    IdExp* src = new IdExp(soas[r->value].arrays[f]);
+                    dst->ty = src->ty = t;
+                    b->StmList.insert(it, new AssignStm(dst, src));
+                }
+                it = b->StmList.erase(it);
+                --it;
+                continue;
+            }
+            if (elementStore(a)) {
+                IndexExp* dst = soaElement(a->lhs);
+                const string& var = static_cast<IdExp*>(dst->array)->value;
+                Layout& lay = soas[var];
+                Exp* index = rewrite(dst->index);
+                for (auto& f : lay.fields) {
+                    b->StmList.insert(it, new AssignStm(fieldArray(var, f, cloneExp(index)),
+                                                        fieldValue(a->e, f, lay.structName)));
+                }
+                it = b->StmList.erase(it);
+                --it;
+                continue;
+            }
+            a->lhs = rewrite(a->lhs);
+            a->e   = rewrite(a->e);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  p->e = rewrite(p->e);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) r->e = rewrite(r->e);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            i->condition = rewrite(i->condition);
+            rewriteBody(i->then, false);
+            rewriteBody(i->els, false);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            w->condition = rewrite(w->condition);
+            rewriteBody(w->b, false);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            m->scrutinee = rewrite(m->scrutinee);
+            for (auto arm : m->arms) rewriteBody(arm->body, false);
+            rewriteBody(m->otherwise, false);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) rewrite(fs->call);
+    }
+}
+
+// ----------------- Pasada -----------------
+
+void StructOfArrays::optimizeBody(Body* b) {
+    if (!b) return;
+    soas.clear();
+    copies.clear();
+    profitable.clear();
+
+    // solo los let del nivel superior declarados una vez
+    unordered_map<string, int> decls;
+    countLets(b, decls);
+    for (auto v : b->vars) {
+        Layout lay;
+        if (decls[v->id] == 1 && transformable(v, lay)) soas[v->id] = lay;
+    }
+    if (soas.empty()) return;
+
+    checkBody(b);
+    for (auto it = soas.begin(); it != soas.end(); ) {
+        if (profitable.count(it->first)) ++it;
+        else it = soas.erase(it);
+    }
+    // una copia entre arrays exige que ambos cambien de disposición
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (auto& c : copies) {
+            if (soas.count(c.first) != soas.count(c.second)) {
+                soas.erase(c.first);
+                soas.erase(c.second);
+                changed = true;
+            }
+        }
+    }
+    if (!soas.empty()) rewriteBody(b, true);
+    soas.clear();
+}
+
+void StructOfArrays::optimize(Program* p) {
+    for (auto f : p->fdlist) optimizeBody(f->cuerpo);
+    for (auto impl : p->impls) optimizeBody(impl->body);
+}
@@ -0,0 +1,52 @@
+#ifndef SOA_H
+#define SOA_H
+
+#include "ast.h"
+#include <list>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Array de structs a struct de arrays (SoA). Un array local de structs con campos
+// escalares que solo se usa elemento a elemento (pts[i].x, pts[i] = P { ... },
+// let p: P = pts[i]) se guarda como un array contiguo por campo: pts[i].x pasa a
+// ser __soa_pts_x[i]. Un bucle que solo recorre un campo usa entera cada línea de
+// caché y, con campos i64, el vectorizador de loopopt puede tratarlo. Solo se
+// transforma si algún bucle toca una parte de los campos (si todos los bucles
+// leen el elemento completo, AoS ya es lo mejor), y nunca si el array se usa
+// entero (argumento, return, copia a un array sin transformar).
+class StructOfArrays {
+public:
+    int minLength = 2;     // elementos mínimos para transformar
+
+    void optimize(Program* p);
+
+private:
+    struct Layout {
+        std::string structName;
+        int length = 0;
+        std::vector<std::string> fields;                      // orden de declaración
+        std::unordered_map<std::string, std::string> arrays;  // campo -> array
+        std::unordered_map<std::string, std::string> types;   // campo -> tipo escalar
+    };
+    std::unordered_map<std::string, Layout> soas;      // arrays a transformar
+    std::vector<std::pair<std::string, std::string>> copies;   // qs = pts entre candidatos
+    std::unordered_map<std::string, std::set<std::string>>* loopFields = nullptr;  // bucle en curso
+    std::set<std::string> profitable;                  // algún bucle usa solo parte de los campos
+
+    void optimizeBody(Body* b);
+    bool transformable(LetStm* v, Layout& lay);
+    IndexExp* soaElement(Exp* e);
+    bool elementStore(AssignStm* a);
+    void touch(IndexExp* element, const std::string& field);
+    void checkExp(Exp* e);
+    void checkBody(Body* b);
+
+    Exp* fieldArray(const std::string& var, const std::string& field, Exp* index);
+    Exp* fieldValue(Exp* e, const std::string& field, const std::string& structName);
+    Exp* rewrite(Exp* e);
+    void rewriteBody(Body* b, bool top);
+};
+
+#endif
@@ -0,0 +1,266 @@
+#include "sra.h"
+#include "visitor.h"
+
+using std::list;
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+// ----------------- Candidatos -----------------
+
+bool ScalarReplacement::splittable(LetStm* v, Aggregate& agg) {
+    string prefix = "__sra_" + v->id + "_";
+
+    auto st = structTable.find(v->type);
+    if (st != structTable.end()) {
+        if (v->e && !dynamic_cast<StructLitExp*>(v->e)) return false;
+        for (auto& f : st->second.fieldOrder) {
+            string t = st->second.fieldType[f];
+            if (isAggregateType(t)) return false;
+            agg.field[f] = agg.parts.size();
+            agg.parts.push_back(prefix + f);
+            agg.types.push_back(t);
+        }
+        return !agg.parts.empty();
+    }
+
+    string elem;
+    int len;
+    if (!isArrayType(v->type)) return false;
+    parseArrayType(v->type, elem, len);
+    if (len <= 0 || len > maxArrayLength || isAggregateType(elem)) return false;
+    auto al = dynamic_cast<ArrayLitExp*>(v->e);
+    if (v->e && (!al || (int)al->elems.size() != len)) return false;
+    agg.isArray = true;
+    for (int i = 0; i < len; i++) {
+        agg.parts.push_back(prefix + std::to_string(i));
+        agg.types.push_back(elem);
+    }
+    return true;
+}
+
+// valor de cada parte en un literal completo (los campos omitidos valen 0)
+vector<Exp*> ScalarReplacement::literalParts(const string& var, Exp* lit) {
+    Aggregate& agg = aggs[var];
+    vector<Exp*> vals(agg.parts.size(), nullptr);
+    if (auto al = dynamic_cast<ArrayLitExp*>(lit)) {
+        for (size_t i = 0; i < vals.size(); i++) vals[i] = al->elems[i];
+    } else if (auto sl = dynamic_cast<StructLitExp*>(lit)) {
+        for (auto& f : sl->fields) {
+            if (agg.field.count(f.first)) vals[agg.field[f.first]] = f.second;
+        }
+    }
+    for (auto& x : vals) if (!x) x = new NumberExp(0);
+    return vals;
+}
+
+// p = P { ... } / a = [ ... ] que no lee el propio agregado
+bool ScalarReplacement::literalAssign(AssignStm* a) {
+    auto id = dynamic_cast<IdExp*>(a->lhs);
+    if (!id || !aggs.count(id->value)) return false;
+    Aggregate& agg = aggs[id->value];
+    if (agg.isArray) {
+        auto al = dynamic_cast<ArrayLitExp*>(a->e);
+        if (!al || al->elems.size() != agg.parts.size()) return false;
+    } else if (!dynamic_cast<StructLitExp*>(a->e)) {
+        return false;
+    }
+    return !mentions(a->e, id->value);
+}
+
+// descarta los agregados que se usan enteros o con índices no constantes
+void ScalarReplacement::checkExp(Exp* e) {
+    if (!e) return;
+    if (auto id = dynamic_cast<IdExp*>(e)) {
+        aggs.erase(id->value);
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        auto id = dynamic_cast<IdExp*>(fa->base);
+        if (id && aggs.count(id->value)) {
+            if (!aggs[id->value].field.count(fa->field)) aggs.erase(id->value);
+            return;
+        }
+        checkExp(fa->base);
+    }
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        auto id = dynamic_cast<IdExp*>(ix->array);
+        if (id && aggs.count(id->value)) {
+            auto k = dynamic_cast<NumberExp*>(ix->index);
+            Aggregate& agg = aggs[id->value];
+            if (!agg.isArray || !k || k->value < 0 || k->value >= (int)agg.parts.size()) {
+                aggs.erase(id->value);
+            }
+        } else {
+            checkExp(ix->array);
+        }
+        checkExp(ix->index);
+    }
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        checkExp(b->left);
+        checkExp(b->right);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : f->argumentos) checkExp(a);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) checkExp(f.second);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) checkExp(x);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) checkExp(c->e);
+}
+
+void ScalarReplacement::checkBody(Body* b) {
+    if (!b) return;
+    for (auto v : b->vars) checkExp(v->e);
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            if (!literalAssign(a)) checkExp(a->lhs);
+            checkExp(a->e);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  checkExp(p->e);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) checkExp(r->e);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            checkExp(i->condition);
+            checkBody(i->then);
+            checkBody(i->els);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            checkExp(w->condition);
+            checkBody(w->b);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            checkExp(m->scrutinee);
+            for (auto arm : m->arms) checkBody(arm->body);
+            checkBody(m->otherwise);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) checkExp(fs->call);
+    }
+}
+
+// ----------------- Reescritura -----------------
+
+Exp* ScalarReplacement::rewrite(Exp* e) {
+    if (!e) return e;
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        auto id = dynamic_cast<IdExp*>(fa->base);
+        if (id && aggs.count(id->value)) {
+            Aggregate& agg = aggs[id->value];
+            int k = agg.field[fa->field];
+            IdExp* part = new IdExp(agg.parts[k]);
+            part->ty = agg.types[k];
+            return part;
+        }
+        fa->base = rewrite(fa->base);
+    }
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        auto id = dynamic_cast<IdExp*>(ix->array);
+        if (id && aggs.count(id->value)) {
+            Aggregate& agg = aggs[id->value];
+            int k = static_cast<NumberExp*>(ix->index)->value;
+            IdExp* part = new IdExp(agg.parts[k]);
+            part->ty = agg.types[k];
+            return part;
+        }
+        ix->array = rewrite(ix->array);
+        ix->index = rewrite(ix->index);
+    }
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        b->left  = rewrite(b->left);
+        b->right = rewrite(b->right);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto &a : f->argumentos) a = rewrite(a);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) f.second = rewrite(f.second);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto &x : al->elems) x = rewrite(x);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) c->e = rewrite(c->e);
+    return e;
+}
+
+void ScalarReplacement::rewriteBody(Body* b, bool top) {
+    if (!b) return;
+
+    list<LetStm*> vars;
+    for (auto v : b->vars) {
+        if (top && aggs.count(v->id)) {
+            Aggregate& agg = aggs[v->id];
+            vector<Exp*> vals = v->e ? literalParts(v->id, v->e) : vector<Exp*>(agg.parts.size(), nullptr);
+            for (size_t k = 0; k < agg.parts.size(); k++) {
+                vars.push_back(new LetStm(agg.parts[k], agg.types[k], rewrite(vals[k]), true));
+            }
+            continue;
+        }
+        v->e = rewrite(v->e);
+        vars.push_back(v);
+    }
+    b->vars = vars;
+
+    for (auto it = b->StmList.begin(); it != b->StmList.end(); ++it) {
+        Stm* s = *it;
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            if (literalAssign(a)) {
+                string var = static_cast<IdExp*>(a->lhs)->value;
+                Aggregate& agg = aggs[var];
+                vector<Exp*> vals = literalParts(var, a->e);
+                for (size_t k = 0; k < agg.parts.size(); k++) {
+                    IdExp* part = new IdExp(agg.parts[k]);
+                    part->ty = agg.types[k];
+                    b->StmList.insert(it, new AssignStm(part, rewrite(vals[k])));
+                }
+                it = b->StmList.erase(it);
+                --it;
+                continue;
+            }
+            a->lhs = rewrite(a->lhs);
+            a->e   = rewrite(a->e);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  p->e = rewrite(p->e);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) r->e = rewrite(r->e);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            i->condition = rewrite(i->condition);
+            rewriteBody(i->then, false);
+            rewriteBody(i->els, false);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            w->condition = rewrite(w->condition);
+            rewriteBody(w->b, false);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            m->scrutinee = rewrite(m->scrutinee);
+            for (auto arm : m->arms) rewriteBody(arm->body, false);
+            rewriteBody(m->otherwise, false);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) rewrite(fs->call);
+    }
+}
+
+// ----------------- Pasada -----------------
+
+void ScalarReplacement::optimizeBody(Body* b) {
+    if (!b) return;
+    aggs.clear();
+
+    // solo los let del nivel superior (los únicos con slot propio) declarados una vez
+    unordered_map<string, int> decls;
+    countLets(b, decls);
+    for (auto v : b->vars) {
+        Aggregate agg;
+        if (decls[v->id] == 1 && splittable(v, agg)) aggs[v->id] = agg;
+    }
+    if (aggs.empty()) return;
+
+    checkBody(b);
+    if (!aggs.empty()) rewriteBody(b, true);
+    aggs.clear();
+}
+
+void ScalarReplacement::optimize(Program* p) {
+    for (auto f : p->fdlist) optimizeBody(f->cuerpo);
+    for (auto impl : p->impls) optimizeBody(impl->body);
+}
@@ -0,0 +1,42 @@
+#ifndef SRA_H
+#define SRA_H
+
+#include "ast.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reemplazo escalar de agregados (SRA). Un struct local que solo se usa campo a
+// campo (p.x) y un array pequeño indexado solo con constantes (a[2]) se dividen
+// en un let escalar por campo o elemento: dejan de tener memoria propia en el
+// frame y se tratan como cualquier otra variable (operandos directos, isel,
+// coloreado de slots). Si el agregado se usa entero (argumento, print, return,
+// operador sobrecargado, índice variable) se deja como está; las asignaciones
+// completas de un literal (p = P { ... }) se reparten campo a campo.
+class ScalarReplacement {
+public:
+    int maxArrayLength = 8;    // elementos máximos de un array a dividir
+
+    void optimize(Program* p);
+
+private:
+    struct Aggregate {
+        std::vector<std::string> parts;      // nombre de cada escalar
+        std::vector<std::string> types;
+        std::unordered_map<std::string, int> field;   // campo -> parte (structs)
+        bool isArray = false;
+    };
+    std::unordered_map<std::string, Aggregate> aggs;   // locales a dividir
+
+    void optimizeBody(Body* b);
+    bool splittable(LetStm* v, Aggregate& agg);
+    void checkExp(Exp* e);
+    void checkBody(Body* b);
+    bool literalAssign(AssignStm* a);
+    std::vector<Exp*> literalParts(const std::string& var, Exp* lit);
+
+    Exp* rewrite(Exp* e);
+    void rewriteBody(Body* b, bool top);
+};
+
+#endif
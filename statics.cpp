@@ -0,0 +1,135 @@
+#include "statics.h"
+#include "layout.h"
+#include "typechecker.h"
+
+using std::string;
+using std::vector;
+
+// ----------------- Valores -----------------
+
+// Literal de la parte del static que lee `e` (nullptr: no está en el literal, vale
+// cero) y su tipo. Falla si `e` no es un camino constante a un static no mut.
+bool StaticFolding::resolve(Exp* e, Exp*& lit, string& t) {
+    if (auto id = dynamic_cast<IdExp*>(e)) {
+        auto it = constants.find(id->value);
+        if (it == constants.end() || shadowed.count(id->value)) return false;
+        lit = it->second->val;
+        t = it->second->type;
+        return true;
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        if (!resolve(fa->base, lit, t) || !structTable.count(t)) return false;
+        StructInfo& info = structTable[t];
+        if (!info.fieldType.count(fa->field)) return false;
+        t = info.fieldType[fa->field];
+        Exp* field = nullptr;
+        if (auto sl = dynamic_cast<StructLitExp*>(lit)) {
+            for (auto &f : sl->fields) if (f.first == fa->field) field = f.second;
+        } else if (lit) {
+            return false;
+        }
+        lit = field;
+        return true;
+    }
+    if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        auto k = dynamic_cast<NumberExp*>(ix->index);
+        if (!k || !resolve(ix->array, lit, t) || !isArrayType(t)) return false;
+        string elem;
+        int len = 0;
+        parseArrayType(t, elem, len);
+        if (k->value < 0 || k->value >= len) return false;
+        t = elem;
+        Exp* item = nullptr;
+        if (auto al = dynamic_cast<ArrayLitExp*>(lit)) {
+            if (k->value < (long long)al->elems.size()) item = al->elems[k->value];
+        } else if (lit) {
+            return false;
+        }
+        lit = item;
+        return true;
+    }
+    return false;
+}
+
+// ----------------- Reescritura -----------------
+
+Exp* StaticFolding::rewrite(Exp* e) {
+    if (!e) return e;
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) fa->base = rewrite(fa->base);
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        ix->array = rewrite(ix->array);
+        ix->index = rewrite(ix->index);
+    }
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        b->left  = rewrite(b->left);
+        b->right = rewrite(b->right);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto &a : f->argumentos) a = rewrite(a);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) f.second = rewrite(f.second);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto &x : al->elems) x = rewrite(x);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) c->e = rewrite(c->e);
+
+    Exp* lit = nullptr;
+    string t;
+    if (!resolve(e, lit, t) || !isIntType(t)) return e;
+    auto num = dynamic_cast<NumberExp*>(lit);
+    if (lit && !num) return e;
+    NumberExp* value = new NumberExp(num ? num->value : 0);
+    value->ty = t;
+    return value;
+}
+
+void StaticFolding::rewriteBody(Body* b) {
+    if (!b) return;
+    for (auto v : b->vars) v->e = rewrite(v->e);
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            a->lhs = rewrite(a->lhs);
+            a->e   = rewrite(a->e);
+        }
+        else if (auto p = dynamic_cast<PrintStm*>(s))  p->e = rewrite(p->e);
+        else if (auto r = dynamic_cast<ReturnStm*>(s)) r->e = rewrite(r->e);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            i->condition = rewrite(i->condition);
+            rewriteBody(i->then);
+            rewriteBody(i->els);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            w->condition = rewrite(w->condition);
+            rewriteBody(w->b);
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            m->scrutinee = rewrite(m->scrutinee);
+            for (auto arm : m->arms) rewriteBody(arm->body);
+            rewriteBody(m->otherwise);
+        }
+        else if (auto fs = dynamic_cast<FcallStm*>(s)) rewrite(fs->call);
+    }
+}
+
+// ----------------- Pasada -----------------
+
+void StaticFolding::optimizeFunction(const vector<string>& params, Body* b) {
+    // un parámetro o un let con el nombre de un static lo tapa en toda la función
+    shadowed.clear();
+    shadowed.insert(params.begin(), params.end());
+    collectLets(b, shadowed);
+    rewriteBody(b);
+}
+
+void StaticFolding::optimize(Program* p) {
+    constants.clear();
+    for (auto gv : p->vdlist) {
+        if (!gv->mut) constants[gv->var] = gv;
+    }
+    if (constants.empty()) return;
+
+    for (auto f : p->fdlist) optimizeFunction(f->Pnombres, f->cuerpo);
+    for (auto impl : p->impls) optimizeFunction({"self", impl->paramName}, impl->body);
+}
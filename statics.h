@@ -0,0 +1,30 @@
+#ifndef STATICS_H
+#define STATICS_H
+
+#include "ast.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Propagación de statics no mut. Nunca se escriben (lo comprueba el typechecker)
+// y su valor inicial es un literal, así que cada lectura de un escalar (LIMIT),
+// de un campo (ORIGIN.x) o de un elemento con índice constante (TABLE[3]) se
+// sustituye por el número: desaparece la carga de .rodata y las pasadas
+// siguientes ven una constante (límites de bucle, operandos inmediatos). Los usos
+// que quedan (índice variable, el agregado entero) siguen leyendo de .rodata.
+class StaticFolding {
+public:
+    void optimize(Program* p);
+
+private:
+    std::unordered_map<std::string, GlobalVar*> constants;   // statics no mut
+    std::unordered_set<std::string> shadowed;                // parámetros y lets de la función
+
+    void optimizeFunction(const std::vector<std::string>& params, Body* b);
+    bool resolve(Exp* e, Exp*& lit, std::string& t);
+    Exp* rewrite(Exp* e);
+    void rewriteBody(Body* b);
+};
+
+#endif
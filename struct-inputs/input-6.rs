@@ -0,0 +1,17 @@
+struct A {
+    f: i64,
+    b: B,
+    g: i64,
+}
+
+struct B {
+    x: i64,
+    y: i64,
+    z: i64,
+}
+
+fn main() {
+    let a: A = A { f: 1, b: B { x: 2, y: 3, z: 4 }, g: 60 };
+    println!("{}", a.f + a.b.x + a.b.y + a.b.z + a.g);
+    return(0);
+}
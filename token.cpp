@@ -76,6 +76,13 @@ ostream& operator<<(ostream& outs, const Token& tok) {
         case Token::TYPE:    outs << "TOKEN(TYPE, \""    << tok.text << "\")"; break;
         case Token::SELF:    outs << "TOKEN(SELF, \""    << tok.text << "\")"; break;
         case Token::FOR:    outs << "TOKEN(FOR, \""    << tok.text << "\")"; break;
+        case Token::MATCH:    outs << "TOKEN(MATCH, \""    << tok.text << "\")"; break;
+        case Token::FATARROW:    outs << "TOKEN(FATARROW, \""    << tok.text << "\")"; break;
+        case Token::DOTDOT:    outs << "TOKEN(DOTDOT, \""    << tok.text << "\")"; break;
+        case Token::DOTDOTEQ:    outs << "TOKEN(DOTDOTEQ, \""    << tok.text << "\")"; break;
+        case Token::UNDERSCORE:    outs << "TOKEN(UNDERSCORE, \""    << tok.text << "\")"; break;
+        case Token::BAR:    outs << "TOKEN(BAR, \""    << tok.text << "\")"; break;
+        case Token::AS:    outs << "TOKEN(AS, \""    << tok.text << "\")"; break;
 
 
         case Token::END:    outs << "TOKEN(END)"; break;
@@ -57,7 +57,14 @@ public:
         IMPL,
         TYPE,
         SELF,
-        FOR
+        FOR,
+        MATCH,
+        FATARROW,  // =>
+        DOTDOT,    // ..
+        DOTDOTEQ,  // ..=
+        UNDERSCORE, // _
+        BAR,       // |
+        AS         // as
     };
 
     // Atributos
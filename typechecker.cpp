@@ -1,28 +1,76 @@
 #include "typechecker.h"
 #include "ast.h"
 #include <stdexcept>
+#include <cstdint>
 #include <iostream>
 
 extern std::unordered_map<std::string, std::string> g_opImplFunc;
 extern std::unordered_map<std::string, std::string> g_opImplResult;
-extern std::unordered_map<std::string, StructInfo>  structTable;
 
 
-bool isArrayType(const std::string& t) {
-    return !t.empty() && t.front() == '[' && t.back() == ']';
+// bool vale 0/1 y se opera como i64; solo cambia su tamaño dentro de structs y arrays
+static std::string valueType(const std::string& t) {
+    if (isArrayType(t)) {
+        std::string elem;
+        int len = 0;
+        parseArrayType(t, elem, len);
+        return "[" + valueType(elem) + ";" + std::to_string(len) + "]";
+    }
+    return t == "bool" ? "i64" : t;
+}
+
+// ¿cabe el literal v en el entero t?
+static bool fitsIn(const std::string& t, long long v) {
+    if (t == "i32") return v >= INT32_MIN && v <= INT32_MAX;
+    if (t == "u32") return v >= 0 && v <= (long long)UINT32_MAX;
+    if (t == "u8")  return v >= 0 && v <= 255;
+    return t == "i64";
 }
 
-void parseArrayType(const std::string& t, std::string& elemType, int& length) {
-    size_t semi  = t.find(';');
-    size_t close = t.rfind(']');
-    if (semi == std::string::npos || close == std::string::npos) {
-        elemType = "i64";
-        length = 1;
-        return;
+// ¿puede `e` (de tipo et) guardarse en algo de tipo t? Un literal entero toma el
+// tipo entero del destino si su valor cabe, también dentro de una operación
+// entre literales (0 - 20) o de un literal de array.
+bool TypeChecker::coerce(const std::string& t, Exp* e, const std::string& et) {
+    if (t == et) return true;
+    if (auto n = dynamic_cast<NumberExp*>(e)) {
+        if (!fitsIn(t, n->value)) return false;
+        n->ty = t;
+        return true;
     }
-    elemType = t.substr(1, semi - 1);
-    std::string nStr = t.substr(semi + 1, close - semi - 1);
-    length = std::stoi(nStr);
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        if (b->hasOverloadedImpl || b->op == LT_OP || !isIntType(t)) return false;
+        if (!coerce(t, b->left, valueType(b->left->ty)) ||
+            !coerce(t, b->right, valueType(b->right->ty))) {
+            return false;
+        }
+        b->ty = t;
+        return true;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        if (!isArrayType(t)) return false;
+        std::string elem;
+        int len = 0;
+        parseArrayType(t, elem, len);
+        if (len != (int)al->elems.size()) return false;
+        for (auto x : al->elems) {
+            if (!coerce(elem, x, valueType(x->ty))) return false;
+        }
+        al->ty = t;
+        return true;
+    }
+    return false;
+}
+
+// tipo entero común de los operandos: el mismo a ambos lados, o un literal que
+// toma el tipo del otro
+bool TypeChecker::intOperands(BinaryExp* e, const std::string& lt, const std::string& rt,
+                              std::string& t) {
+    if (!isIntType(lt) && !isIntType(rt)) return false;
+    if (lt == rt) t = lt;
+    else if (isIntType(lt) && coerce(lt, e->right, rt)) t = lt;
+    else if (isIntType(rt) && coerce(rt, e->left, lt)) t = rt;
+    else return false;
+    return true;
 }
 
 void TypeChecker::checkProgram(Program* p) {
@@ -32,22 +80,24 @@ void TypeChecker::checkProgram(Program* p) {
 
 
 int TypeChecker::visit(Program* p) {
+    structDecs = &p->sdlist;
     for (auto sd : p->sdlist) {
         sd->accept(this);
     }
 
     for (auto fd : p->fdlist) {
         funcReturnTypes[fd->nombre] = fd->tipo;
-    }
-
-    for (auto impl : p->impls) {
-        impl->accept(this);
+        funcParamTypes[fd->nombre] = fd->Ptipos;
     }
 
     for (auto gv : p->vdlist) {
         gv->accept(this);  
     }
 
+    for (auto impl : p->impls) {
+        impl->accept(this);
+    }
+
     for (auto fd : p->fdlist) {
         fd->accept(this);
     }
@@ -58,43 +108,17 @@ int TypeChecker::visit(Program* p) {
 // ===================== StructDec =====================
 
 int TypeChecker::visit(StructDec* s) {
-   
-    StructInfo info;
-    int idx = 0;
-    auto itType = s->body->types.begin();
-
-    for (auto& name : s->body->atributes) {
-        info.fieldOrder.push_back(name);
-        info.fieldOffset[name] = idx;
-        info.fieldType[name]   = *itType;
-
-        int fieldSize = /* getTypeSize(*itType) */ 8;
-        idx += fieldSize;
-        ++itType;
-    }
-    info.totalSize = idx;
-    structTable[s->nombre] = std::move(info);
+    layoutStruct(s, *structDecs);
     return 0;
 }
 
 // ===================== ImplDec =====================
 
 int TypeChecker::visit(ImplDec* impl) {
-    if (impl->traitName != "Add" &&
-        impl->traitName != "Sub" &&
-        impl->traitName != "Mul" &&
-        impl->traitName != "Div") {
-        return 0;
-    }
-
-    std::string opName;
-    if      (impl->traitName == "Add") opName = "add";
-    else if (impl->traitName == "Sub") opName = "sub";
-    else if (impl->traitName == "Mul") opName = "mul";
-    else if (impl->traitName == "Div") opName = "div";
+    std::string fname = opImplName(impl);
+    if (fname.empty()) return 0;
 
     std::string key   = impl->traitName + "#" + impl->typeName + "#" + impl->paramType;
-    std::string fname = "__op_" + opName + "_" + impl->typeName + "_" + impl->paramType;
 
     g_opImplFunc[key]   = fname;
     g_opImplResult[key] = impl->returnType;
@@ -105,10 +129,13 @@ int TypeChecker::visit(ImplDec* impl) {
 
     currentFunctionReturnType = impl->returnType;
     currentFunctionName       = fname;
-    varTypes.clear();
+    varTypes = globalTypes;
+    readOnly = immutableStatics;
 
     varTypes["self"]          = impl->typeName;
     varTypes[impl->paramName] = impl->paramType;
+    readOnly.erase("self");
+    readOnly.erase(impl->paramName);
 
     impl->body->accept(this);
 
@@ -128,10 +155,12 @@ int TypeChecker::visit(FunDec* f) {
 
     currentFunctionReturnType = f->tipo;
     currentFunctionName       = f->nombre;
-    varTypes.clear();
+    varTypes = globalTypes;
+    readOnly = immutableStatics;
 
     for (size_t i = 0; i < f->Pnombres.size(); ++i) {
         varTypes[f->Pnombres[i]] = f->Ptipos[i];
+        readOnly.erase(f->Pnombres[i]);
     }
 
     f->cuerpo->accept(this);
@@ -157,27 +186,39 @@ int TypeChecker::visit(Body* b) {
 // ===================== LetStm =====================
 
 int TypeChecker::visit(LetStm* s) {
-    std::string t = s->type;    
+    std::string t = valueType(s->type);
     std::string et = typeOf(s->e);
 
-    if (t != et) {
+    if (!coerce(t, s->e, et)) {
         throw std::runtime_error(
             "Tipo incompatible en let " + s->id +
             ": declarado " + t + " pero la expresión tiene tipo " + et
         );
     }
 
-    varTypes[s->id] = t;
+    varTypes[s->id] = s->type;
+    readOnly.erase(s->id);
     return 0;
 }
 
 // ===================== AssignStm =====================
 
 int TypeChecker::visit(AssignStm* s) {
+    Exp* root = s->lhs;
+    for (;;) {
+        if (auto fa = dynamic_cast<FieldAccessExp*>(root)) root = fa->base;
+        else if (auto ix = dynamic_cast<IndexExp*>(root)) root = ix->array;
+        else break;
+    }
+    if (auto id = dynamic_cast<IdExp*>(root)) {
+        if (readOnly.count(id->value))
+            throw std::runtime_error("Asignación a static no mut: " + id->value);
+    }
+
     std::string lt = typeOf(s->lhs);
     std::string rt = typeOf(s->e);
 
-    if (lt != rt) {
+    if (!coerce(lt, s->e, rt)) {
         throw std::runtime_error(
             "Asignación incompatible: LHS tiene tipo " + lt +
             " y RHS tiene tipo " + rt
@@ -191,7 +232,7 @@ int TypeChecker::visit(AssignStm* s) {
 int TypeChecker::visit(ReturnStm* s) {
     std::string et = typeOf(s->e);
     if (currentFunctionReturnType != "void" &&
-        et != currentFunctionReturnType) {
+        !coerce(valueType(currentFunctionReturnType), s->e, et)) {
         throw std::runtime_error(
             "Tipo de retorno incompatible en funcion " + currentFunctionName +
             ": se esperaba " + currentFunctionReturnType +
@@ -205,7 +246,7 @@ int TypeChecker::visit(ReturnStm* s) {
 
 std::string TypeChecker::typeOf(Exp* e) {
     e->accept(this);
-    return e->ty;
+    return valueType(e->ty);
 }
 
 // --------- NumberExp ---------
@@ -220,6 +261,16 @@ int TypeChecker::visit(StringExp* e) {
     return 0;
 }
 
+// --------- CastExp ---------
+int TypeChecker::visit(CastExp* e) {
+    std::string src = typeOf(e->e);
+    if (!isIntType(src) || !isIntType(e->type) || e->type == "bool") {
+        throw std::runtime_error("Conversión no soportada: " + src + " as " + e->type);
+    }
+    e->ty = e->type;
+    return 0;
+}
+
 // --------- IdExp ---------
 int TypeChecker::visit(IdExp* e) {
     auto it = varTypes.find(e->value);
@@ -272,8 +323,19 @@ int TypeChecker::visit(FcallExp* e) {
     if (it == funcReturnTypes.end()) {
         throw std::runtime_error("Llamada a función no declarada: " + e->nombre);
     }
-    for (auto arg : e->argumentos) {
-        typeOf(arg);  
+    auto itP = funcParamTypes.find(e->nombre);
+    for (size_t i = 0; i < e->argumentos.size(); ++i) {
+        Exp* arg = e->argumentos[i];
+        std::string at = typeOf(arg);
+        if (itP == funcParamTypes.end() || i >= itP->second.size()) continue;
+        // los enteros llegan ya extendidos al tipo del parámetro
+        std::string pt = valueType(itP->second[i]);
+        if (isIntType(pt) && !coerce(pt, arg, at)) {
+            throw std::runtime_error(
+                "Argumento " + std::to_string(i + 1) + " de " + e->nombre +
+                ": se esperaba " + pt + " pero tiene tipo " + at
+            );
+        }
     }
     e->ty = it->second;
     return 0;
@@ -287,6 +349,7 @@ int TypeChecker::visit(BinaryExp* e) {
 
     e->hasOverloadedImpl = false;
     e->implFuncName.clear();
+    std::string t;
 
     auto tryTrait = [&](const std::string& trait) {
         std::string key = trait + "#" + lt + "#" + rt;
@@ -304,9 +367,9 @@ int TypeChecker::visit(BinaryExp* e) {
     switch (e->op) {
         // ---------- + ----------
         case PLUS_OP: {
-            // builtin
-            if (lt == "i64" && rt == "i64") {
-                e->ty = "i64";
+            // builtin: se opera en el tipo entero común
+            if (intOperands(e, lt, rt, t)) {
+                e->ty = t;
                 return 0;
             }
             // sobrecarga: impl Add for T
@@ -319,8 +382,8 @@ int TypeChecker::visit(BinaryExp* e) {
 
         // ---------- - ----------
         case MINUS_OP: {
-            if (lt == "i64" && rt == "i64") {
-                e->ty = "i64";
+            if (intOperands(e, lt, rt, t)) {
+                e->ty = t;
                 return 0;
             }
             if (tryTrait("Sub")) return 0;
@@ -332,8 +395,8 @@ int TypeChecker::visit(BinaryExp* e) {
 
         // ---------- * ----------
         case MUL_OP: {
-            if (lt == "i64" && rt == "i64") {
-                e->ty = "i64";
+            if (intOperands(e, lt, rt, t)) {
+                e->ty = t;
                 return 0;
             }
             if (tryTrait("Mul")) return 0;
@@ -345,8 +408,8 @@ int TypeChecker::visit(BinaryExp* e) {
 
         // ---------- / ----------
         case DIV_OP: {
-            if (lt == "i64" && rt == "i64") {
-                e->ty = "i64";
+            if (intOperands(e, lt, rt, t)) {
+                e->ty = t;
                 return 0;
             }
             if (tryTrait("Div")) return 0;
@@ -358,8 +421,8 @@ int TypeChecker::visit(BinaryExp* e) {
 
         // ---------- < ----------
         case LT_OP: {
-            if (lt != "i64" || rt != "i64") {
-                throw std::runtime_error("Operador '<' requiere i64");
+            if (!intOperands(e, lt, rt, t)) {
+                throw std::runtime_error("Operador '<' requiere enteros del mismo tipo");
             }
             e->ty = "i64"; // tu bool es i64
             return 0;
@@ -367,10 +430,10 @@ int TypeChecker::visit(BinaryExp* e) {
 
         // ---------- ^ (POW_OP) o lo que tengas ----------
         case POW_OP: {
-            if (lt != "i64" || rt != "i64") {
-                throw std::runtime_error("Operador '^' requiere i64");
+            if (!intOperands(e, lt, rt, t)) {
+                throw std::runtime_error("Operador '^' requiere enteros del mismo tipo");
             }
-            e->ty = "i64";
+            e->ty = t;
             return 0;
         }
     }
@@ -406,14 +469,41 @@ int TypeChecker::visit(IfStm* stm) {
     return 0;
 }
 
+int TypeChecker::visit(MatchStm* stm) {
+    if (!isIntType(typeOf(stm->scrutinee))) {
+        throw std::runtime_error("La expresión de un match debe ser entera");
+    }
+    for (auto arm : stm->arms) {
+        for (auto &r : arm->ranges) {
+            if (r.first > r.second) {
+                throw std::runtime_error("Rango vacío en un brazo del match");
+            }
+        }
+        arm->body->accept(this);
+    }
+    if (stm->otherwise) stm->otherwise->accept(this);
+    return 0;
+}
+
 int TypeChecker::visit(VarDec* vd) {
     
     return 0;
 }
 
 int TypeChecker::visit(GlobalVar* gv) {
+    std::string t = valueType(gv->type);
+    std::string et = typeOf(gv->val);
+
+    if (!coerce(t, gv->val, et)) {
+        throw std::runtime_error(
+            "Tipo incompatible en static " + gv->var +
+            ": declarado " + t + " pero la expresión tiene tipo " + et
+        );
+    }
 
-    typeOf(gv->val);
+    globalTypes[gv->var] = gv->type;
+    varTypes[gv->var] = gv->type;
+    if (!gv->mut) immutableStatics.insert(gv->var);
     return 0;
 }
 
@@ -441,8 +531,8 @@ int TypeChecker::visit(IndexExp* e) {
     std::string baseType = typeOf(e->array);
     std::string idxType  = typeOf(e->index);
 
-    if (idxType != "i64") {
-        throw std::runtime_error("Índice de array debe ser i64");
+    if (!isIntType(idxType)) {
+        throw std::runtime_error("Índice de array debe ser entero");
     }
 
     std::string elemType;
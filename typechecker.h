@@ -1,20 +1,27 @@
 #pragma once
 #include "ast.h"
 #include "visitor.h"
+#include "layout.h"
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
+#include <vector>
 
 extern std::unordered_map<std::string, std::string> g_addImplName;   
 extern std::unordered_map<std::string, std::string> g_addResultType; 
 
 
-bool isArrayType(const std::string& t);
-void parseArrayType(const std::string& t, std::string& elemType, int& length);
-
 struct TypeChecker : public Visitor {
     std::unordered_map<std::string, std::string> varTypes;
+    const std::list<StructDec*>* structDecs = nullptr;   // para disponer structs anidados
+
+    // statics: visibles en todas las funciones; los no mut no se pueden asignar
+    std::unordered_map<std::string, std::string> globalTypes;
+    std::unordered_set<std::string> immutableStatics;
+    std::unordered_set<std::string> readOnly;   // statics no mut sin tapar en la función actual
 
     std::unordered_map<std::string, std::string> funcReturnTypes;
+    std::unordered_map<std::string, std::vector<std::string>> funcParamTypes;
 
     std::string currentFunctionReturnType;
     std::string currentFunctionName;
@@ -34,6 +41,7 @@ struct TypeChecker : public Visitor {
 
     int visit(NumberExp* e) override;
     int visit(StringExp* e) override;
+    int visit(CastExp* e) override;
     int visit(IdExp* e) override;
     int visit(BinaryExp* e) override;
     int visit(FieldAccessExp* e) override;
@@ -43,6 +51,7 @@ struct TypeChecker : public Visitor {
     int visit(PrintStm* stm) override;
     int visit(WhileStm* stm) override;
     int visit(IfStm* stm) override;
+    int visit(MatchStm* stm) override;
     int visit(VarDec* vd) override;
     int visit(GlobalVar* gv) override;
     int visit(StructLitExp* e) override;
@@ -52,4 +61,6 @@ struct TypeChecker : public Visitor {
 
 private:
     std::string typeOf(Exp* e);  // helper
+    bool coerce(const std::string& t, Exp* e, const std::string& et);
+    bool intOperands(BinaryExp* e, const std::string& lt, const std::string& rt, std::string& t);
 };
@@ -1,13 +1,18 @@
 #include <iostream>
 #include "ast.h"
 #include "visitor.h"
+#include "loopopt.h"
 #include "accept.cpp"
 
 #include <unordered_map>
+#include <unordered_set>
+#include <sstream>
+#include <algorithm>
+#include <set>
+#include <cstdint>
 using namespace std;
 
 string g_lastType; 
-unordered_map<string, StructInfo> structTable; 
 
 static unordered_map<string, string> g_stringLabels;   
 static int g_nextStringId = 0;
@@ -16,40 +21,197 @@ static int g_nextStringId = 0;
 unordered_map<string, string> g_opImplFunc;
 unordered_map<string, string> g_opImplResult;
 
-static unordered_map<string, bool> g_pointerParams;
 
 
 
 // --- helpers ---
 
-static bool isArrayType(const std::string& t) {
-    return !t.empty() && t.front() == '[' && t.back() == ']';
+
+int GenCodeVisitor::getTypeSize(const string& t) {
+    return (typeSize(t) + 7) / 8 * 8;
+}
+
+static const char* dataDirective(int size) {
+    return size == 1 ? ".byte " : size == 4 ? ".long " : ".quad ";
+}
+
+static const char* sizedMov(int size) {
+    return size == 1 ? " movb" : size == 4 ? " movl" : " movq";
+}
+
+static bool fitsImm32(long long v) {
+    return v >= INT32_MIN && v <= INT32_MAX;
 }
 
-static void parseArrayType(const std::string& t, std::string& elemType, int& length) {
-    size_t semi  = t.find(';');
-    size_t close = t.rfind(']');
-    if (semi == std::string::npos || close == std::string::npos) {
-        elemType = "i64";
-        length = 1;
+// %rax = escalar de tipo t en src (extendido a 64 bits)
+void GenCodeVisitor::emitLoad(const string& t, const string& src) {
+    int size = typeSize(t);
+    if (size == 1)      out << " movzbq " << src << ", %rax" << endl;
+    else if (t == "i32") out << " movslq " << src << ", %rax" << endl;
+    else if (size == 4) out << " movl " << src << ", %eax" << endl;
+    else                out << " movq " << src << ", %rax" << endl;
+}
+
+void GenCodeVisitor::emitStore(const string& t, const string& dst) {
+    int size = typeSize(t);
+    if (size == 1)      out << " movb %al, " << dst << endl;
+    else if (size == 4) out << " movl %eax, " << dst << endl;
+    else                out << " movq %rax, " << dst << endl;
+}
+
+// trunca %rax al entero estrecho t y lo vuelve a extender a 64 bits
+void GenCodeVisitor::emitNarrow(const string& t) {
+    if (t == "i32")      out << " movslq %eax, %rax\n";
+    else if (t == "u32") out << " movl %eax, %eax\n";
+    else if (t == "u8")  out << " movzbl %al, %eax\n";
+}
+
+// Copia de un struct o array de tamaño conocido, (%rsi) -> (%rdi). Solo usa %rax
+// y registros vectoriales: %rdi, %rsi y %rcx quedan intactos. Según el tamaño:
+// hasta copyUnrollMaxBytes, movdqu desenrollados (el último trozo se solapa con el
+// anterior en vez de bajar a 8/4/1 bytes); hasta copyVectorMaxBytes, un bucle de
+// 64 bytes por vuelta con AVX si __rc_simd_level lo permite (SSE si no); más
+// grande, rep movsb, que con ERMS es lo más rápido en bloques largos.
+void GenCodeVisitor::emitBlockCopy(int bytes) {
+    if (bytes <= copyUnrollMaxBytes) {
+        emitCopyChunks(0, bytes);
+        return;
+    }
+    if (bytes > copyVectorMaxBytes) {
+        out << " pushq %rdi\n";
+        out << " pushq %rsi\n";
+        out << " pushq %rcx\n";
+        out << " movq $" << bytes << ", %rcx\n";
+        out << " rep movsb\n";
+        out << " popq %rcx\n";
+        out << " popq %rsi\n";
+        out << " popq %rdi\n";
         return;
     }
-    elemType = t.substr(1, semi - 1);                    // entre '[' y ';'
-    std::string nStr = t.substr(semi + 1, close - semi - 1);
-    length = std::stoi(nStr);
+
+    string L = to_string(labelcont++);
+    int looped = bytes / 64 * 64;
+    usesSimd = true;
+    // __rc_detect_simd pisa %rcx, %rdx, %r10 y %r11, que pueden estar vivos aquí
+    out << " cmpl $0, __rc_simd_level(%rip)\n";
+    out << " jne .Lcready_" << L << "\n";
+    out << " pushq %rcx\n pushq %rdx\n pushq %r10\n pushq %r11\n";
+    out << " call __rc_detect_simd\n";
+    out << " popq %r11\n popq %r10\n popq %rdx\n popq %rcx\n";
+    out << ".Lcready_" << L << ":\n";
+    out << " xorl %eax, %eax\n";
+    out << " cmpl $3, __rc_simd_level(%rip)\n";
+    out << " jl .Lcsse_" << L << "\n";
+    out << ".Lcavx_" << L << ":\n";
+    out << " vmovdqu (%rsi,%rax), %ymm0\n";
+    out << " vmovdqu 32(%rsi,%rax), %ymm1\n";
+    out << " vmovdqu %ymm0, (%rdi,%rax)\n";
+    out << " vmovdqu %ymm1, 32(%rdi,%rax)\n";
+    out << " addq $64, %rax\n";
+    out << " cmpq $" << looped << ", %rax\n";
+    out << " jb .Lcavx_" << L << "\n";
+    out << " vzeroupper\n";
+    out << " jmp .Lctail_" << L << "\n";
+    out << ".Lcsse_" << L << ":\n";
+    for (int k = 0; k < 4; k++)
+        out << " movdqu " << 16 * k << "(%rsi,%rax), %xmm" << k << "\n";
+    for (int k = 0; k < 4; k++)
+        out << " movdqu %xmm" << k << ", " << 16 * k << "(%rdi,%rax)\n";
+    out << " addq $64, %rax\n";
+    out << " cmpq $" << looped << ", %rax\n";
+    out << " jb .Lcsse_" << L << "\n";
+    out << ".Lctail_" << L << ":\n";
+    emitCopyChunks(looped, bytes);
 }
 
-int GenCodeVisitor::getTypeSize(const string& t) {
+// Bytes [from, bytes) de la copia con desplazamientos fijos. Con 16 bytes o más en
+// total, el trozo final empieza en bytes-16 y pisa lo ya copiado, que es igual.
+void GenCodeVisitor::emitCopyChunks(int from, int bytes) {
+    auto move = [&](const char* mov, const string& reg, int off) {
+        out << " " << mov << " " << off << "(%rsi), " << reg << "\n";
+        out << " " << mov << " " << reg << ", " << off << "(%rdi)\n";
+    };
+    auto pair = [&](const char* mov, int a, int b) {
+        out << " " << mov << " " << a << "(%rsi), %xmm0\n";
+        out << " " << mov << " " << b << "(%rsi), %xmm1\n";
+        out << " " << mov << " %xmm0, " << a << "(%rdi)\n";
+        out << " " << mov << " %xmm1, " << b << "(%rdi)\n";
+    };
+    if (from >= bytes) return;
+    if (bytes >= 16) {
+        int off = from;
+        for (; off + 32 <= bytes; off += 32) pair("movdqu", off, off + 16);
+        if (off + 16 <= bytes) { move("movdqu", "%xmm0", off); off += 16; }
+        if (off < bytes) move("movdqu", "%xmm0", bytes - 16);
+    } else if (bytes >= 8) {
+        if (bytes == 8) move("movq", "%xmm0", 0);
+        else pair("movq", 0, bytes - 8);
+    } else if (bytes >= 4) {
+        if (bytes == 4) move("movd", "%xmm0", 0);
+        else pair("movd", 0, bytes - 4);
+    } else {
+        if (bytes >= 2) move("movw", "%ax", 0);
+        if (bytes != 2) move("movb", "%al", bytes - 1);
+    }
+}
+
+static bool allZero(Exp* e) {
+    if (!e) return true;
+    if (auto n = dynamic_cast<NumberExp*>(e)) return n->value == 0;
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) if (!allZero(f.second)) return false;
+        return true;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) if (!allZero(x)) return false;
+        return true;
+    }
+    return false;
+}
+
+// valor inicial de un global en .data según la disposición de su tipo; lo que
+// falta (campos, elementos, relleno) queda a cero
+void GenCodeVisitor::emitData(const string& t, Exp* e, bool constOnly) {
     if (structTable.count(t)) {
-        return structTable[t].totalSize;
+        StructInfo &info = structTable[t];
+        unordered_map<string, Exp*> fieldExprs;
+        if (auto lit = dynamic_cast<StructLitExp*>(e)) {
+            for (auto &f : lit->fields) fieldExprs[f.first] = f.second;
+        }
+        vector<string> byOffset = info.fieldOrder;
+        stable_sort(byOffset.begin(), byOffset.end(), [&](const string& a, const string& b) {
+            return info.fieldOffset[a] < info.fieldOffset[b];
+        });
+        int pos = 0;
+        for (auto &fname : byOffset) {
+            int off = info.fieldOffset[fname];
+            if (off > pos) out << " .zero " << off - pos << endl;
+            string ft = info.fieldType[fname];
+            emitData(ft, fieldExprs.count(fname) ? fieldExprs[fname] : nullptr, constOnly);
+            pos = off + typeSize(ft);
+        }
+        if (info.totalSize > pos) out << " .zero " << info.totalSize - pos << endl;
+        return;
     }
     if (isArrayType(t)) {
-        std::string elemType;
+        string elemType;
         int len = 0;
         parseArrayType(t, elemType, len);
-        return len * getTypeSize(elemType);
+        auto lit = dynamic_cast<ArrayLitExp*>(e);
+        for (int i = 0; i < len; i++) {
+            emitData(elemType, lit && i < (int)lit->elems.size() ? lit->elems[i] : nullptr, constOnly);
+        }
+        return;
+    }
+    // constOnly: imagen de un literal local, lo que no es un número se calcula después
+    if (!e || (constOnly && !dynamic_cast<NumberExp*>(e))) {
+        out << " .zero " << typeSize(t) << endl;
+        return;
     }
-    return 8;
+    dataType = t;
+    structVar = true;
+    e->accept(this);
+    structVar = false;
 }
 
 static string makeAsmString(const string& s) {
@@ -100,6 +262,16 @@ int GenCodeVisitor::visit(Program* program) {
 
     out << ".text\n";
 
+    // firmas de todas las funciones, también de las que aún no se han generado
+    for (auto dec : program->fdlist) {
+        funcReturnTypes[dec->nombre] = dec->tipo;
+        funcParamTypes[dec->nombre] = dec->Ptipos;
+    }
+    for (auto impl : program->impls) {
+        string fname = opImplName(impl);
+        if (!fname.empty()) funcParamTypes[fname] = {impl->typeName, impl->paramType};
+    }
+
     for (auto dec : program->impls)
         dec->accept(this);
 
@@ -107,7 +279,9 @@ int GenCodeVisitor::visit(Program* program) {
     for (auto dec : program->fdlist)
         dec->accept(this);
 
-    if (!g_stringLabels.empty()) {
+    if (usesSimd) emitSimdRuntime();
+
+    if (!g_stringLabels.empty() || !rodataImages.empty()) {
         out << ".section .rodata\n";
         for (auto &p : g_stringLabels) {
             const string &val = p.first;
@@ -115,6 +289,7 @@ int GenCodeVisitor::visit(Program* program) {
             out << lbl << ":\n";
             out << " .string \"" << makeAsmString(val) << "\"\n";
         }
+        out << rodata.str();
     }
 
     out << ".section .note.GNU-stack,\"\",@progbits"<<endl;
@@ -135,11 +310,11 @@ int GenCodeVisitor::visit(VarDec* stm) {
 
 int GenCodeVisitor::visit(NumberExp* exp) {
     if (structVar) {
-        out << ".quad " << exp->value << endl;
+        out << dataDirective(typeSize(dataType)) << exp->value << endl;
     } else if (countStruct) {
         offset = offset - 8;
     } else {
-        out << " movq $" << exp->value << ", %rax" << endl;
+        out << (fitsImm32(exp->value) ? " movq $" : " movabsq $") << exp->value << ", %rax" << endl;
         g_lastType = "i64";   
     }
     return 0;
@@ -149,10 +324,22 @@ int GenCodeVisitor::visit(GlobalVar* exp) {
     varTypes[exp->var] = exp->type; 
     if (!entornoFuncion) {
         memoriaGlobal[exp->var] = true;
+        // un escalar global ocupa un slot de 8 bytes, como los locales
+        bool aggregate = structTable.count(exp->type) || isArrayType(exp->type);
+        string t = aggregate ? exp->type : "i64";
+        // los no mut nunca se escriben; los que empiezan a cero no ocupan sitio en el binario
+        bool zero = exp->mut && allZero(exp->val);
+        if (!exp->mut) out << ".section .rodata" << endl;
+        else if (zero) out << ".bss" << endl;
+        else           out << ".data" << endl;
+        if (isArrayType(exp->type)) {
+            out << " .p2align 5" << endl;   // alineado para cargas vectoriales
+        } else if (typeAlign(exp->type) == 8) {
+            out << " .p2align 3" << endl;
+        }
         out << exp->var << ":" << endl;
-        structVar = true;
-        exp->val->accept(this);
-        structVar = false;
+        if (zero) out << " .zero " << typeSize(t) << endl;
+        else      emitData(t, exp->val);
     } else {
         memoria[exp->var] = offset;
         offset -= 8;
@@ -161,7 +348,7 @@ int GenCodeVisitor::visit(GlobalVar* exp) {
 }
 
 int GenCodeVisitor::visit(IdExp* exp) {
-    if (memoriaGlobal.count(exp->value)) { // Global var
+    if (memoriaGlobal.count(exp->value) && !memoria.count(exp->value)) { // Global var (un local del mismo nombre lo tapa)
         if (varTypes.count(exp->value)) g_lastType = varTypes[exp->value];
 
         bool isStruct = varTypes.count(exp->value) &&
@@ -182,9 +369,9 @@ int GenCodeVisitor::visit(IdExp* exp) {
         bool isArray  = varTypes.count(exp->value) &&
                         isArrayType(varTypes[exp->value]);
 
-        bool isPointerParam = g_pointerParams.count(exp->value) && g_pointerParams[exp->value];
+        bool isPointerParam = pointerParams.count(exp->value) > 0;
 
-        if (isStruct && isPointerParam) {
+        if ((isStruct || isArray) && isPointerParam) {
             out << " movq " << memoria[exp->value] << "(%rbp), %rax" << endl;
         }
         else if (isStruct || isArray) {
@@ -199,239 +386,291 @@ int GenCodeVisitor::visit(IdExp* exp) {
 }
 
 int GenCodeVisitor::visit(IndexExp* exp) {
-    exp->array->accept(this);
-    string arrayType = g_lastType;
-
-    string elemType;
-    int len = 0;
-    if (isArrayType(arrayType)) {
-        parseArrayType(arrayType, elemType, len);
-    } else {
-        elemType = arrayType;          
-    }
-
-    out << " movq %rax, %rcx" << endl;
-
-    exp->index->accept(this);          
-
-    int elemSize = getTypeSize(elemType);
-    out << " imulq $" << elemSize << ", %rax" << endl; 
-    out << " addq %rax, %rcx" << endl;                 
-
-    g_lastType = elemType;
+    AddrMode am;
+    string elemType = selectAddress(exp, am);
 
     if (!structTable.count(elemType) && !isArrayType(elemType)) {
-        out << " movq (%rcx), %rax" << endl;           
+        emitLoad(elemType, am.str());
     } else {
-        out << " movq %rcx, %rax" << endl;             // struct o array -> dirección
+        emitAddress(am, "%rax");             // struct o array -> dirección
     }
+    g_lastType = elemType;
     return 0;
 }
 
-int GenCodeVisitor::visit(BinaryExp* exp) {
-    exp->left->accept(this);
-    out << " pushq %rax\n";
+// ---- orden de evaluación (Sethi-Ullman) ----
+
+bool callFree(Exp* e) {
+    if (!e) return true;
+    if (dynamic_cast<FcallExp*>(e)) return false;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        return !b->hasOverloadedImpl && callFree(b->left) && callFree(b->right);
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return callFree(fa->base);
+    if (auto ix = dynamic_cast<IndexExp*>(e))       return callFree(ix->array) && callFree(ix->index);
+    if (auto c = dynamic_cast<CastExp*>(e))         return callFree(c->e);
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) if (!callFree(f.second)) return false;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) if (!callFree(x)) return false;
+    }
+    return true;
+}
 
-    exp->right->accept(this);
-    out << " movq %rax, %rcx\n";
-    out << " popq %rax\n";  
+// registros para valores intermedios: no son de argumentos ni los usa el resto
+// del generador dentro de una expresión; las llamadas los destruyen
+static const char* tempRegs[] = {"%r10", "%r11"};
+static const int numTempRegs = 2;
 
-    if (exp->hasOverloadedImpl) {
-        out << " movq %rax, %rdi\n"; // self
-        out << " movq %rcx, %rsi\n"; // other
-        out << " call " << exp->implFuncName << "\n";
-        g_lastType = exp->ty;
-        return 0;
+// ¿es `e` un escalar en una dirección fija (x, p.f, a[3], s.v[2].f)? No emite código.
+bool GenCodeVisitor::fixedAddress(Exp* e) {
+    if (auto id = dynamic_cast<IdExp*>(e)) {
+        if (memoriaGlobal.count(id->value) && !memoria.count(id->value)) return true;
+        return memoria.count(id->value) && !pointerParams.count(id->value);
+    }
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return fixedAddress(fa->base);
+    if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        return dynamic_cast<NumberExp*>(ix->index) && fixedAddress(ix->array);
     }
+    return false;
+}
 
-    if (exp->op == LT_OP) {
-        out << " cmpq %rcx, %rax\n"
-            << " movl $0, %eax\n"
-            << " setl %al\n"
-            << " movzbq %al, %rax\n";
-        g_lastType = "i64";   
-        return 0;
+// operando directo de una instrucción ALU: inmediato o memoria
+bool GenCodeVisitor::directOperand(Exp* e, string& opnd) {
+    if (auto n = dynamic_cast<NumberExp*>(e)) {
+        opnd = "$" + to_string(n->value);
+        return fitsImm32(n->value);
     }
+    if (!fixedAddress(e)) return false;
+    AddrMode am;
+    string t = selectAddress(e, am);
+    if (structTable.count(t) || isArrayType(t)) return false;
+    if (!dynamic_cast<IdExp*>(e) && typeSize(t) != 8) return false;   // campo estrecho
+    opnd = am.str();
+    return true;
+}
 
+// Etiqueta de Sethi-Ullman: registros necesarios para evaluar `e`. Un operando
+// directo no necesita ninguno a la derecha (va en la propia instrucción).
+int GenCodeVisitor::regNeed(Exp* e, bool isLeft) {
+    string opnd;
+    if (dynamic_cast<NumberExp*>(e) || fixedAddress(e)) return isLeft ? 1 : 0;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        if (b->hasOverloadedImpl) return numTempRegs + 2;
+        int l = regNeed(b->left, true);
+        int r = regNeed(b->right, false);
+        return l == r ? l + 1 : max(l, r);
+    }
+    if (auto ix = dynamic_cast<IndexExp*>(e)) return max(2, regNeed(ix->index, true) + 1);
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) return regNeed(fa->base, true);
+    if (auto c = dynamic_cast<CastExp*>(e))         return max(1, regNeed(c->e, true));
+    return 1;
+}
 
-    switch (exp->op) {
+// %rax = %rax op src (src: inmediato, memoria o registro distinto de %rax/%rdx)
+void GenCodeVisitor::emitArith(BinaryOp op, const string& src, bool swapped) {
+    switch (op) {
         case PLUS_OP:
-            out << " addq %rcx, %rax\n";
+            out << " addq " << src << ", %rax\n";
             break;
         case MINUS_OP:
-            out << " subq %rcx, %rax\n";
+            out << " subq " << src << ", %rax\n";
             break;
         case MUL_OP:
-            out << " imulq %rcx, %rax\n";
+        case POW_OP:
+            out << " imulq " << src << ", %rax\n";
             break;
         case DIV_OP:
-            out << " cqto\n";          // sign-extend RAX a RDX:RAX
-            out << " idivq %rcx\n";    // RAX = RAX / RCX
+            if (src[0] == '$') {
+                out << " movq " << src << ", %rcx\n";
+                out << " cqto\n";
+                out << " idivq %rcx\n";
+            } else {
+                out << " cqto\n";          // sign-extend RAX a RDX:RAX
+                out << " idivq " << src << "\n";
+            }
             break;
-        case POW_OP:
-            out << " imulq %rcx, %rax\n";
+        case LT_OP:
+            // swapped: %rax es el operando derecho, a < b  <=>  b > a
+            out << " cmpq " << src << ", %rax\n"
+                << " movl $0, %eax\n"
+                << " " << (swapped ? "setg" : "setl") << " %al\n"
+                << " movzbq %al, %rax\n";
             break;
         default:
             break;
     }
+}
 
-    g_lastType = "i64";   // todos devuelven i64
+// i32, u32 y u8 se operan en 64 bits y el resultado se trunca a su tipo
+int GenCodeVisitor::visit(BinaryExp* exp) {
+    emitBinary(exp);
+    if (!exp->hasOverloadedImpl && exp->op != LT_OP) emitNarrow(exp->ty);
     return 0;
 }
 
+int GenCodeVisitor::visit(CastExp* exp) {
+    exp->e->accept(this);
+    emitNarrow(exp->type);
+    g_lastType = exp->type;
+    return 0;
+}
 
-int GenCodeVisitor::visit(AssignStm* stm) {
-    std::string lhsType = emitLValueAddress(stm->lhs);
-
-    bool lhsIsStruct = structTable.count(lhsType);
-    bool lhsIsArray  = isArrayType(lhsType);
+void GenCodeVisitor::emitBinary(BinaryExp* exp) {
+    if (exp->hasOverloadedImpl) {
+        bool sret = isAggregateType(exp->ty);
+        string dest = sret ? resultDest(typeSize(exp->ty)) : "";
+        // self y other, como cualquier llamada
+        emitCallArgs({exp->left, exp->right}, funcParamTypes[exp->implFuncName], sret ? 1 : 0);
+        if (sret) out << dest << "\n";
+        out << " call " << exp->implFuncName << "\n";
+        g_lastType = exp->ty;
+        return;
+    }
 
-    if (lhsIsStruct) {
-        if (auto lit = dynamic_cast<StructLitExp*>(stm->e)) {
-            StructInfo &info = structTable[lhsType];
-            std::unordered_map<std::string, Exp*> fieldExprs;
-            for (auto &f : lit->fields) {
-                fieldExprs[f.first] = f.second;
-            }
+    // patrones de la tabla (isel.cpp); si ninguno aplica, orden de Sethi-Ullman
+    if (isel.selectExp(exp)) {
+        g_lastType = "i64";
+        return;
+    }
 
-            for (const std::string &fname : info.fieldOrder) {
-                Exp *fe = fieldExprs.count(fname) ? fieldExprs[fname] : nullptr;
-                std::string fType = info.fieldType[fname];
-                int off = info.fieldOffset[fname];
-
-                if (structTable.count(fType)) {
-                    // struct anidado
-                    StructInfo &nInfo = structTable[fType];
-                    StructLitExp* nestedLit = fe ? dynamic_cast<StructLitExp*>(fe) : nullptr;
-
-                    std::unordered_map<std::string, Exp*> nestedMap;
-                    if (nestedLit) {
-                        for (auto &nf : nestedLit->fields) {
-                            nestedMap[nf.first] = nf.second;
-                        }
-                    }
+    BinaryOp op = exp->op;
+    bool commutative = op == PLUS_OP || op == MUL_OP || op == POW_OP || op == LT_OP;
+    string opnd;
 
-                    out << " leaq " << off << "(%rcx), %rdx\n"; 
-
-                    for (const std::string &nfName : nInfo.fieldOrder) {
-                        Exp *nfExp = nestedMap.count(nfName) ? nestedMap[nfName] : nullptr;
-                        if (nfExp) {
-                            nfExp->accept(this);   // %rax = valor
-                        } else {
-                            out << " movq $0, %rax\n";
-                        }
-                        int nOff = nInfo.fieldOffset[nfName];
-                        out << " movq %rax, " << nOff << "(%rdx)\n";
-                    }
-                } else {
-                    // campo escalar
-                    if (fe) {
-                        fe->accept(this);          // %rax = valor
-                    } else {
-                        out << " movq $0, %rax\n";
-                    }
-                    out << " movq %rax, " << off << "(%rcx)\n";
-                }
+    if (directOperand(exp->right, opnd)) {
+        // x op 5, x op y: el derecho va como operando de la instrucción
+        exp->left->accept(this);
+        emitArith(op, opnd);
+    }
+    else if (callFree(exp->right) && directOperand(exp->left, opnd)) {
+        // 5 op (...): se evalúa el derecho y el izquierdo va directo; si el derecho
+        // tiene llamadas, podrían cambiar el izquierdo (un static) antes de leerlo
+        exp->right->accept(this);
+        if (commutative) {
+            emitArith(op, opnd, true);
+        } else {
+            out << " movq %rax, %rcx\n";
+            out << " movq " << opnd << ", %rax\n";
+            emitArith(op, "%rcx");
+        }
+    }
+    else {
+        // primero el subárbol que necesita más registros; el otro resultado espera
+        // en un registro libre, o en la pila si se acabaron o si hay llamadas. Con
+        // llamadas en cualquier lado se respeta el orden de izquierda a derecha.
+        bool rightFirst = callFree(exp->left) && callFree(exp->right) &&
+                          regNeed(exp->right, false) > regNeed(exp->left, true);
+        Exp* first  = rightFirst ? exp->right : exp->left;
+        Exp* second = rightFirst ? exp->left  : exp->right;
+
+        first->accept(this);
+        if (tempsInUse < numTempRegs && callFree(second)) {
+            string t = tempRegs[tempsInUse++];
+            out << " movq %rax, " << t << "\n";
+            second->accept(this);
+            tempsInUse--;
+            if (rightFirst) {
+                emitArith(op, t);
+            } else if (commutative) {
+                emitArith(op, t, true);
+            } else {
+                out << " movq %rax, %rcx\n";
+                out << " movq " << t << ", %rax\n";
+                emitArith(op, "%rcx");
             }
-
-            out << " movq %rcx, %rax\n";           // resultado = &lhs
-            return 0;
+        } else {
+            out << " pushq %rax\n";
+            second->accept(this);
+            if (rightFirst) {
+                out << " popq %rcx\n";
+            } else {
+                out << " movq %rax, %rcx\n";
+                out << " popq %rax\n";
+            }
+            emitArith(op, "%rcx");
         }
     }
 
-    if (lhsIsArray) {
-        if (auto litArr = dynamic_cast<ArrayLitExp*>(stm->e)) {
-            std::string elemType;
-            int len = 0;
-            parseArrayType(lhsType, elemType, len);
-            int elemSize = getTypeSize(elemType);
-
-            // Array de structs
-            if (structTable.count(elemType)) {
-                StructInfo &info = structTable[elemType];
-
-                for (int i = 0; i < len; ++i) {
-                    int elemOff = i * elemSize;
-                    out << " leaq " << elemOff << "(%rcx), %rdx\n"; // &lhs[i]
+    g_lastType = "i64";   // todos devuelven i64
+}
 
-                    StructLitExp *se = nullptr;
-                    if (i < (int)litArr->elems.size()) {
-                        se = dynamic_cast<StructLitExp*>(litArr->elems[i]);
-                    }
 
-                    std::unordered_map<std::string, Exp*> fieldExprs;
-                    if (se) {
-                        for (auto &f : se->fields) {
-                            fieldExprs[f.first] = f.second;
-                        }
-                    }
+int GenCodeVisitor::visit(AssignStm* stm) {
+    // iv = iv + c dentro de un bucle reducido: avanzar también los punteros
+    if (auto id = dynamic_cast<IdExp*>(stm->lhs)) {
+        auto itB = ivBumps.find(id->value);
+        auto inc = dynamic_cast<BinaryExp*>(stm->e);
+        auto step = inc ? dynamic_cast<NumberExp*>(inc->right) : nullptr;
+        if (itB != ivBumps.end() && step) {
+            for (auto &b : itB->second) {
+                out << " addq $" << step->value * b.second << ", " << b.first << "(%rbp)\n";
+            }
+            if (ivEliminated.count(id->value)) return 0;
+        }
+    }
 
-                    for (const std::string &fname : info.fieldOrder) {
-                        Exp *fe = fieldExprs.count(fname) ? fieldExprs[fname] : nullptr;
-                        std::string fType = info.fieldType[fname];
-                        int fOff = info.fieldOffset[fname];
-
-                        if (structTable.count(fType)) {
-                            out << " movq $0, %rax\n";
-                            out << " movq %rax, " << fOff << "(%rdx)\n";
-                        } else {
-                            if (fe) {
-                                fe->accept(this);  // %rax = valor
-                            } else {
-                                out << " movq $0, %rax\n";
-                            }
-                            out << " movq %rax, " << fOff << "(%rdx)\n";
-                        }
-                    }
-                }
+    // escalar en dirección fija: patrones de asignación (incq, addq $k, mem...)
+    if (isel.selectAssign(stm->lhs, stm->e)) return 0;
 
-                out << " movq %rcx, %rax\n";
-                return 0;
-            }
+    AddrMode am;
+    std::string lhsType = selectAddress(stm->lhs, am);
 
-            // Array de escalares
-            for (int i = 0; i < len; ++i) {
-                if (i < (int)litArr->elems.size()) {
-                    litArr->elems[i]->accept(this); // %rax = valor
-                } else {
-                    out << " movq $0, %rax\n";
-                }
-                int off = i * elemSize;
-                out << " movq %rax, " << off << "(%rcx)\n";
-            }
+    bool lhsIsStruct = structTable.count(lhsType);
+    bool lhsIsArray  = isArrayType(lhsType);
 
-            out << " movq %rcx, %rax\n";
+    if (!lhsIsStruct && !lhsIsArray) {
+        // las variables ocupan un slot de 8 bytes; campos y elementos, su tamaño
+        string st = dynamic_cast<IdExp*>(stm->lhs) ? "i64" : lhsType;
+        if (!am.usesRegs()) {
+            // destino en el frame o global: se escribe directo, sin %rcx
+            stm->e->accept(this);
+            emitStore(st, am.str());
             return 0;
         }
-    }
 
+        // %rcx = &lhs; una hoja (número/variable) no toca %rcx
+        bool leaf = dynamic_cast<NumberExp*>(stm->e) || dynamic_cast<IdExp*>(stm->e);
+        emitAddress(am, "%rcx");
+        if (!leaf) out << " pushq %rcx" << endl;
 
-    if (!lhsIsStruct && !lhsIsArray) {
-        // %rcx = &lhs
-        out << " pushq %rcx" << endl;       
-
-        stm->e->accept(this);        
+        stm->e->accept(this);
 
-        out << " popq %rcx" << endl;        
-        out << " movq %rax, (%rcx)" << endl; 
+        if (!leaf) out << " popq %rcx" << endl;
+        emitStore(st, "(%rcx)");
         return 0;
     }
 
-    if (lhsIsStruct || lhsIsArray) {
-        out << " pushq %rcx\n";          
-
-        stm->e->accept(this);            
-
-        int totalSize = getTypeSize(lhsType);
+    // literal de struct/array: campo a campo, directo desde %rbp/%rip si se puede
+    bool lit = (lhsIsStruct && dynamic_cast<StructLitExp*>(stm->e)) ||
+               (lhsIsArray && dynamic_cast<ArrayLitExp*>(stm->e));
+    if (lit) {
+        AddrMode dst = am;
+        if (am.usesRegs()) {
+            emitAddress(am, "%rcx");
+            dst = AddrMode();
+            dst.base = "%rcx";
+        }
+        emitInit(lhsType, stm->e, dst);
+        return 0;
+    }
 
-        out << " movq %rax, %rsi\n";     
-        out << " popq %rdi\n";          
-        out << " movq $" << (totalSize / 8) << ", %rcx\n";
-        out << " rep movsq\n";
-        out << " movq %rdi, %rax\n";
+    // a = f(...): la llamada escribe directamente en a (solo locales: un global
+    // podría leerlo el callee)
+    if (!am.usesRegs() && am.sym.empty() && emitResultInto(stm->e, " leaq " + am.str() + ", %rdi")) {
         return 0;
     }
 
+    emitAddress(am, "%rcx");
+    out << " pushq %rcx\n";
+
+    stm->e->accept(this);
+
+    out << " movq %rax, %rsi\n";
+    out << " popq %rdi\n";
+    emitBlockCopy(typeSize(lhsType));
+    out << " movq %rdi, %rax\n";
     return 0;
 }
 
@@ -452,16 +691,84 @@ int GenCodeVisitor::visit(PrintStm* stm) {
 }
 
 int GenCodeVisitor::visit(Body* b) {
-    for (auto s : b->StmList)
+    for (auto s : b->StmList) {
+        tempUsed = 0;                 // temporales de la sentencia anterior, libres
         s->accept(this);
+    }
     return 0;
 }
 
+// ---- if-conversion ----
+
+// Coste (nodos) de evaluar `e` incondicionalmente, o -1 si no se puede especular:
+// llamadas, divisiones (pueden fallar) y accesos a direcciones calculadas.
+int GenCodeVisitor::speculationCost(Exp* e) {
+    string opnd;
+    if (directOperand(e, opnd)) return 1;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        if (b->hasOverloadedImpl || b->op == DIV_OP) return -1;
+        int l = speculationCost(b->left);
+        int r = speculationCost(b->right);
+        return (l < 0 || r < 0) ? -1 : 1 + l + r;
+    }
+    return -1;
+}
+
+static AssignStm* singleAssign(Body* b) {
+    if (!b || !b->vars.empty() || b->StmList.size() != 1) return nullptr;
+    return dynamic_cast<AssignStm*>(b->StmList.front());
+}
+
+// if (c) { m = a } else { m = b }  ->  m = c ? a : b con cmov, sin saltos.
+// Sin else (triángulo) el valor alternativo es el propio m.
+bool GenCodeVisitor::emitIfConversion(IfStm* stm) {
+    AssignStm* thenA = singleAssign(stm->then);
+    AssignStm* elseA = nullptr;
+    if (!thenA || tempsInUse != 0) return false;
+    bool triangle = !stm->els || (stm->els->vars.empty() && stm->els->StmList.empty());
+    if (!triangle && !(elseA = singleAssign(stm->els))) return false;
+
+    string dst, other;
+    if (!fixedAddress(thenA->lhs) || !directOperand(thenA->lhs, dst)) return false;
+    if (elseA && (!fixedAddress(elseA->lhs) || !directOperand(elseA->lhs, other) || other != dst)) {
+        return false;
+    }
+    if (auto id = dynamic_cast<IdExp*>(thenA->lhs)) {
+        if (ivBumps.count(id->value)) return false;
+    }
+
+    int cost = speculationCost(thenA->e);
+    int costElse = elseA ? speculationCost(elseA->e) : 0;
+    if (cost < 0 || costElse < 0 || cost + costElse > ifConvertMaxCost) return false;
+    if (!callFree(stm->condition)) return false;
+
+    // valor de un brazo en un temporal (directo si es hoja)
+    auto armValue = [&](Exp* e, const char* reg) {
+        string opnd;
+        if (directOperand(e, opnd)) {
+            out << " movq " << opnd << ", " << reg << "\n";
+        } else {
+            e->accept(this);
+            out << " movq %rax, " << reg << "\n";
+        }
+    };
+    armValue(thenA->e, "%r10");
+    tempsInUse = 1;
+    if (elseA) armValue(elseA->e, "%r11");
+    tempsInUse = 2;
+    string cc;
+    isel.selectFlags(stm->condition, cc);
+    tempsInUse = 0;
+
+    out << " cmov" << cc << " " << (elseA ? "%r11" : dst) << ", %r10\n";
+    out << " movq %r10, " << dst << "\n";
+    return true;
+}
+
 int GenCodeVisitor::visit(IfStm* stm) {
+    if (emitIfConversion(stm)) return 0;
     int label = labelcont++;
-    stm->condition->accept(this);
-    out << " cmpq $0, %rax"<<endl;
-    out << " je else_" << label << endl;
+    isel.selectCond(stm->condition, "else_" + to_string(label));
     stm->then->accept(this);
     out << " jmp endif_" << label << endl;
     out << " else_" << label << ":"<< endl;
@@ -470,345 +777,1520 @@ int GenCodeVisitor::visit(IfStm* stm) {
     return 0;
 }
 
-int GenCodeVisitor::visit(WhileStm* stm) {
-    int label = labelcont++;
-    out << "while_" << label << ":"<<endl;
-    stm->condition->accept(this);
-    out << " cmpq $0, %rax" << endl;
-    out << " je endwhile_" << label << endl;
-    stm->b->accept(this);
-    out << " jmp while_" << label << endl;
-    out << "endwhile_" << label << ":"<< endl;
-    return 0;
-}
-
-int GenCodeVisitor::visit(ReturnStm* stm) {
-    std::string retType = currentFunctionReturnType;
-
-    if (!isArrayType(retType)) {
-        stm->e->accept(this);              
-        out << " jmp .end_" << nombreFuncion << "\n";
-        return 0;
-    }
-
-    std::string elemType;
-    int len = 0;
-    parseArrayType(retType, elemType, len);
-    int elemSize  = getTypeSize(elemType);
-    int totalSize = getTypeSize(retType);  
+// ---- match ----
 
-    if (auto lit = dynamic_cast<ArrayLitExp*>(stm->e)) {
-        for (int i = 0; i < len; ++i) {
-            if (i < (int)lit->elems.size()) {
-                lit->elems[i]->accept(this);  
+// Árbol de búsqueda binaria sobre los intervalos ordenados cases[l, r); el valor
+// está en %rax. Con pocos intervalos, comparaciones en cadena.
+void GenCodeVisitor::emitMatchSearch(const vector<MatchCase>& cases, size_t l, size_t r,
+                                     const string& pfx) {
+    // cmpq con un valor de 64 bits: si no cabe como inmediato, pasa por %rdx
+    auto cmpImm = [&](long long v, const string& reg) {
+        if (fitsImm32(v)) {
+            out << " cmpq $" << v << ", " << reg << "\n";
+        } else {
+            out << " movabsq $" << v << ", %rdx\n";
+            out << " cmpq %rdx, " << reg << "\n";
+        }
+    };
+    if (r - l <= 3) {
+        for (size_t i = l; i < r; i++) {
+            const MatchCase& c = cases[i];
+            if (c.lo == c.hi) {
+                cmpImm(c.lo, "%rax");
+                out << " je " << pfx << c.arm << "\n";
             } else {
-                out << " movq $0, %rax\n";     
+                // lo <= x <= hi  <=>  (x - lo) <= hi - lo sin signo (en módulo 2^64)
+                long long negLo = (long long)(0ULL - (unsigned long long)c.lo);
+                long long width = (long long)((unsigned long long)c.hi - (unsigned long long)c.lo);
+                if (fitsImm32(negLo)) {
+                    out << " leaq " << negLo << "(%rax), %rcx\n";
+                } else {
+                    out << " movabsq $" << negLo << ", %rcx\n";
+                    out << " addq %rax, %rcx\n";
+                }
+                cmpImm(width, "%rcx");
+                out << " jbe " << pfx << c.arm << "\n";
             }
-            int off = i * elemSize;
-            out << " movq %rax, " << off << "(%rdi)\n";
         }
-        out << " movq %rdi, %rax\n";
-    } else {
-        stm->e->accept(this);          
-        out << " movq %rax, %rsi\n";  
-        out << " movq $" << (totalSize / 8) << ", %rcx\n";
-        out << " rep movsq\n";
-        out << " movq %rdi, %rax\n";   
+        out << " jmp " << pfx << "default\n";
+        return;
     }
-
-    out << " jmp .end_" << nombreFuncion << "\n";
-    return 0;
+    size_t mid = (l + r) / 2;
+    string left = pfx + "lt" + to_string(mid);
+    cmpImm(cases[mid].lo, "%rax");
+    out << " jl " << left << "\n";
+    emitMatchSearch(cases, mid, r, pfx);
+    out << left << ":\n";
+    emitMatchSearch(cases, l, mid, pfx);
 }
 
-int GenCodeVisitor::visit(LetStm* exp) {
-    // Registrar tipo de la variable
-    varTypes[exp->id] = exp->type;
-
-    // PRIMER PASE: solo calcular offsets
-    if (countStruct) {
-        int size = getTypeSize(exp->type);
-        offset -= size;
-        memoria[exp->id] = offset;
-        return 0;
+int GenCodeVisitor::visit(MatchStm* stm) {
+    string pfx = ".Lm" + to_string(labelcont++) + "_";
+
+    // intervalos disjuntos y ordenados; donde dos brazos se solapan gana el primero
+    vector<MatchCase> cases;
+    for (size_t k = 0; k < stm->arms.size(); k++) {
+        for (auto &rg : stm->arms[k]->ranges) {
+            vector<pair<long long, long long>> pieces = {{rg.first, rg.second}};
+            for (auto &c : cases) {
+                vector<pair<long long, long long>> rest;
+                for (auto &p : pieces) {
+                    if (p.second < c.lo || p.first > c.hi) {
+                        rest.push_back(p);
+                        continue;
+                    }
+                    if (p.first < c.lo)  rest.push_back({p.first, c.lo - 1});
+                    if (p.second > c.hi) rest.push_back({c.hi + 1, p.second});
+                }
+                pieces = rest;
+            }
+            for (auto &p : pieces) cases.push_back({p.first, p.second, (int)k});
+        }
     }
-
-    if (structTable.count(exp->type)) { // let l: Line = Line { ... };
-        int baseOff = memoria[exp->id];
-        StructInfo &info = structTable[exp->type];
-        auto *lit = dynamic_cast<StructLitExp*>(exp->e);
-
-        unordered_map<string, Exp*> fieldExprs;
-        if (lit) {
-            for (auto &f : lit->fields)
-                fieldExprs[f.first] = f.second;
+    sort(cases.begin(), cases.end(),
+         [](const MatchCase& a, const MatchCase& b) { return a.lo < b.lo; });
+    vector<MatchCase> merged;
+    for (auto &c : cases) {
+        if (!merged.empty() && merged.back().arm == c.arm && merged.back().hi < c.lo &&
+            merged.back().hi + 1 == c.lo) {
+            merged.back().hi = c.hi;
+        } else {
+            merged.push_back(c);
+        }
+    }
+    cases = merged;
+
+    stm->scrutinee->accept(this);
+
+    if (!cases.empty()) {
+        long long lo = cases.front().lo;
+        // anchura sin signo (con patrones en todo el rango de i64 no desborda);
+        // -1 si es demasiado ancho para una tabla o una máscara
+        unsigned long long spanM1 = (unsigned long long)cases.back().hi - (unsigned long long)lo;
+        long long span = spanM1 < (1ULL << 32) ? (long long)spanM1 + 1 : -1;
+        long long covered = 0;
+        unordered_set<int> arms;
+        for (auto &c : cases) {
+            if (span > 0) covered += c.hi - c.lo + 1;
+            arms.insert(c.arm);
         }
 
-        for (const std::string &fname : info.fieldOrder) {
-            Exp *fe = fieldExprs.count(fname) ? fieldExprs[fname] : nullptr;
-            string fType   = info.fieldType[fname];
-            int   fieldOff = info.fieldOffset[fname];
-
-            if (structTable.count(fType)) {
-                StructInfo &nestedInfo = structTable[fType];
-
-                StructLitExp* nestedLit = nullptr;
-                if (fe) {
-                    nestedLit = dynamic_cast<StructLitExp*>(fe);
-                }
+        bool bitTest = span > 0 && span <= 64 && (int)arms.size() <= bitTestMaxArms && cases.size() >= 3;
+        bool table = !bitTest && span > 0 && (int)cases.size() >= jumpTableMinCases &&
+                     span <= jumpTableMaxSpan && covered * 100 >= span * jumpTableMinDensity;
 
-                unordered_map<string, Exp*> nestedMap;
-                if (nestedLit) {
-                    for (auto &nf : nestedLit->fields) {
-                        nestedMap[nf.first] = nf.second;
-                    }
-                }
+        if (bitTest || table) {
+            // valor relativo al mínimo; fuera de [0, span) va al comodín
+            if (lo != 0 && fitsImm32(lo)) out << " subq $" << lo << ", %rax\n";
+            else if (lo != 0) {
+                out << " movabsq $" << lo << ", %rcx\n";
+                out << " subq %rcx, %rax\n";
+            }
+            out << " cmpq $" << (span - 1) << ", %rax\n";
+            out << " ja " << pfx << "default\n";
+        }
 
-                // &l.from o &l.to en %rdx
-                out << " leaq " << (baseOff + fieldOff) << "(%rbp), %rdx\n";
-
-                // rellenar campos del struct anidado (Point)
-                for (const std::string &nfName : nestedInfo.fieldOrder) {
-                    Exp *nfExp    = nestedMap.count(nfName) ? nestedMap[nfName] : nullptr;
-                    std::string nfType = nestedInfo.fieldType[nfName];
-                    int nOff      = nestedInfo.fieldOffset[nfName];
-
-                    if (structTable.count(nfType)) {
-                        out << " movq $0, %rax\n";
-                        out << " movq %rax, " << nOff << "(%rdx)\n";
-                    } else {
-                        if (nfExp) {
-                            nfExp->accept(this);      // %rax = valor del campo
-                        } else {
-                            out << " movq $0, %rax\n";
-                        }
-                        out << " movq %rax, " << nOff << "(%rdx)\n";
-                    }
+        if (bitTest) {
+            // conjunto pequeño: un bit por valor en una máscara por brazo
+            for (auto &k : std::set<int>(arms.begin(), arms.end())) {
+                unsigned long long mask = 0;
+                for (auto &c : cases) {
+                    if (c.arm != k) continue;
+                    for (long long v = c.lo - lo; v <= c.hi - lo; v++) mask |= 1ULL << v;
                 }
+                out << " movabsq $" << mask << ", %rcx\n";
+                out << " btq %rax, %rcx\n";
+                out << " jc " << pfx << k << "\n";
             }
-            else {
-                if (fe)
-                    fe->accept(this);              // %rax = valor del campo
-                else
-                    out << " movq $0, %rax\n";
-
-                out << " leaq " << baseOff << "(%rbp), %rdx\n";
-                out << " movq %rax, " << fieldOff << "(%rdx)\n";
+            out << " jmp " << pfx << "default\n";
+        }
+        else if (table) {
+            // tabla de desplazamientos relativos a la propia tabla (válida en PIE)
+            out << " leaq " << pfx << "table(%rip), %rcx\n";
+            out << " movslq (%rcx,%rax,4), %rax\n";
+            out << " addq %rcx, %rax\n";
+            out << " jmp *%rax\n";
+            out << " .section .rodata\n";
+            out << " .p2align 2\n";
+            out << pfx << "table:\n";
+            size_t i = 0;
+            for (long long j = 0; j < span; j++) {
+                long long v = lo + j;
+                while (cases[i].hi < v) i++;
+                string target = v >= cases[i].lo ? pfx + to_string(cases[i].arm) : pfx + "default";
+                out << " .long " << target << "-" << pfx << "table\n";
             }
+            out << " .text\n";
         }
+        else {
+            emitMatchSearch(cases, 0, cases.size(), pfx);
+        }
+    } else {
+        out << " jmp " << pfx << "default\n";
+    }
+
+    for (size_t k = 0; k < stm->arms.size(); k++) {
+        out << pfx << k << ":\n";
+        stm->arms[k]->body->accept(this);
+        out << " jmp " << pfx << "end\n";
+    }
+    out << pfx << "default:\n";
+    if (stm->otherwise) stm->otherwise->accept(this);
+    out << pfx << "end:\n";
+    return 0;
+}
 
-        out << " leaq " << baseOff << "(%rbp), %rax\n";  
+int GenCodeVisitor::visit(WhileStm* stm) {
+    std::unordered_set<string> locals;
+    for (auto &m : memoria) locals.insert(m.first);
+    ElementwiseLoop ew;
+    if (matchElementwiseLoop(stm, locals, ew)) {
+        emitVectorLoop(ew);
         return 0;
     }
 
-    if (isArrayType(exp->type)) {
-        int baseOff = memoria[exp->id];
-        out << " leaq " << baseOff << "(%rbp), %rcx\n";  // %rcx = &arr
+    auto itPlan = ivPlans.find(stm);
+    if (itPlan != ivPlans.end()) {
+        emitInductionLoop(stm, itPlan->second);
+        return 0;
+    }
 
-        std::string elemType;
-        int len = 0;
-        parseArrayType(exp->type, elemType, len);
-        int elemSize = getTypeSize(elemType);
+    int label = labelcont++;
 
-        auto *lit = dynamic_cast<ArrayLitExp*>(exp->e);
+    // guarda: si la condicion es falsa de entrada no se entra al bucle
+    isel.selectCond(stm->condition, "endwhile_" + to_string(label));
 
-        if (structTable.count(elemType)) {
-            StructInfo &info = structTable[elemType];
+    // bucle rotado: la condicion se prueba al final, un solo salto por iteracion
+    out << " .p2align 4,,10" << endl;
+    out << "while_" << label << ":"<<endl;
+    stm->b->accept(this);
+    isel.selectCond(stm->condition, "while_" + to_string(label), true);
+    out << "endwhile_" << label << ":"<< endl;
+    return 0;
+}
 
-            for (int i = 0; i < len; ++i) {
-                int elemOff = i * elemSize;
-                out << " leaq " << elemOff << "(%rcx), %rdx\n"; // &arr[i]
+bool GenCodeVisitor::ivPointerSlot(IndexExp* exp, int& slot) {
+    auto arr = dynamic_cast<IdExp*>(exp->array);
+    auto idx = dynamic_cast<IdExp*>(exp->index);
+    if (!arr || !idx) return false;
+    auto it = ivPointers.find(arr->value + "#" + idx->value);
+    if (it == ivPointers.end()) return false;
+    slot = it->second;
+    return true;
+}
 
-                StructLitExp *se = nullptr;
-                if (lit && i < (int)lit->elems.size()) {
-                    se = dynamic_cast<StructLitExp*>(lit->elems[i]);
-                }
+// Busca bucles con variable de inducción y reserva en el frame un puntero
+// por cada array a[iv] (y el puntero final si iv se puede eliminar).
+void GenCodeVisitor::planInductionLoops(Body* b, Body* fnBody) {
+    if (!b) return;
+    std::unordered_set<string> locals;
+    for (auto &m : memoria) locals.insert(m.first);
+
+    for (auto s : b->StmList) {
+        if (auto ifs = dynamic_cast<IfStm*>(s)) {
+            planInductionLoops(ifs->then, fnBody);
+            planInductionLoops(ifs->els, fnBody);
+            continue;
+        }
+        if (auto m = dynamic_cast<MatchStm*>(s)) {
+            for (auto arm : m->arms) planInductionLoops(arm->body, fnBody);
+            planInductionLoops(m->otherwise, fnBody);
+            continue;
+        }
+        auto w = dynamic_cast<WhileStm*>(s);
+        if (!w) continue;
+        planInductionLoops(w->b, fnBody);
 
-                unordered_map<std::string, Exp*> fieldExprs;
-                if (se) {
-                    for (auto &f : se->fields)
-                        fieldExprs[f.first] = f.second;
-                }
+        ElementwiseLoop ew;
+        if (matchElementwiseLoop(w, locals, ew)) continue;
 
-                for (const std::string &fname : info.fieldOrder) {
-                    Exp *fe = fieldExprs.count(fname) ? fieldExprs[fname] : nullptr;
-                    string fType = info.fieldType[fname];
-                    int fOff = info.fieldOffset[fname];
-
-                    if (structTable.count(fType)) {
-                        out << " movq $0, %rax\n";
-                        out << " movq %rax, " << fOff << "(%rdx)\n";
-                    } else {
-                        if (fe) {
-                            fe->accept(this);          // %rax = valor del campo
-                        } else {
-                            out << " movq $0, %rax\n";
-                        }
-                        out << " movq %rax, " << fOff << "(%rdx)\n";
-                    }
-                }
-            }
+        IVPlan plan;
+        if (!matchInductionLoop(w, locals, plan.loop) || plan.loop.arrays.empty()) continue;
+
+        for (auto &arr : plan.loop.arrays) {
+            string elemType;
+            int len = 0;
+            parseArrayType(varTypes[arr], elemType, len);
+            offset -= 8;
+            plan.ptrSlots.push_back(offset);
+            plan.elemSizes.push_back(typeSize(elemType));
         }
-        else {
-            if (lit) {
-                // literal [1,2,3]
-                for (int i = 0; i < len; ++i) {
-                    if (i < (int)lit->elems.size()) {
-                        lit->elems[i]->accept(this);   // %rax = valor
-                    } else {
-                        out << " movq $0, %rax\n";     // padding con 0
-                    }
-                    int off = i * elemSize;
-                    out << " movq %rax, " << off << "(%rcx)\n";
-                }
-            } else {
-                exp->e->accept(this);              // %rax = src
-                out << " movq %rax, %rsi\n";       // src
-                out << " movq %rcx, %rdi\n";       // dst = &arr (local)
-                out << " movq $" << (len * elemSize / 8) << ", %rcx\n";
-                out << " rep movsq\n";
-            }
+        // sin lecturas de iv fuera del bucle su valor final no se necesita
+        if (plan.loop.ivOnlyIndexes &&
+            countVarReads(fnBody, plan.loop.iv) == plan.loop.readsInLoop) {
+            plan.lftr = true;
+            offset -= 8;
+            plan.endSlot = offset;
         }
-
-        out << " movq %rcx, %rax\n";
-        return 0;
+        ivPlans[w] = plan;
     }
-
-    exp->e->accept(this);                      // %rax = valor de la expresión
-    out << " movq %rax, " << memoria[exp->id] << "(%rbp)\n";
-    return 0;
 }
 
+void GenCodeVisitor::emitInductionLoop(WhileStm* stm, IVPlan& plan) {
+    int label = labelcont++;
+    InductionLoop& lp = plan.loop;
+    string ivSlot = to_string(memoria[lp.iv]) + "(%rbp)";
+
+    // &a[iv] al entrar al bucle
+    for (size_t k = 0; k < lp.arrays.size(); ++k) {
+        IdExp arr(lp.arrays[k]);
+        arr.accept(this);
+        out << " movq " << ivSlot << ", %rcx\n";
+        out << " imulq $" << plan.elemSizes[k] << ", %rcx\n";
+        out << " addq %rcx, %rax\n";
+        out << " movq %rax, " << plan.ptrSlots[k] << "(%rbp)\n";
+    }
 
-int GenCodeVisitor::visit(FunDec* f) {
-    entornoFuncion = true;
-    memoria.clear();
-    offset = 0;        
-    nombreFuncion = f->nombre;
-
-    vector<string> argRegs = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
+    // iv + k < bound  <=>  &a0[iv] + k*t < &a0[bound]
+    string lftrCmp;
+    if (plan.lftr) {
+        lp.bound->accept(this);
+        out << " imulq $" << plan.elemSizes[0] << ", %rax\n";
+        out << " movq %rax, %rcx\n";
+        IdExp arr0(lp.arrays[0]);
+        arr0.accept(this);
+        out << " addq %rcx, %rax\n";
+        out << " movq %rax, " << plan.endSlot << "(%rbp)\n";
+
+        lftrCmp = " movq " + to_string(plan.ptrSlots[0]) + "(%rbp), %rax\n";
+        if (lp.condOffset) {
+            lftrCmp += " addq $" + to_string(lp.condOffset * plan.elemSizes[0]) + ", %rax\n";
+        }
+        lftrCmp += " cmpq " + to_string(plan.endSlot) + "(%rbp), %rax\n";
+    }
 
-    funcReturnTypes[f->nombre] = f->tipo;
-    currentFunctionReturnType = f->tipo;  
+    for (size_t k = 0; k < lp.arrays.size(); ++k) {
+        ivPointers[lp.arrays[k] + "#" + lp.iv] = plan.ptrSlots[k];
+        ivBumps[lp.iv].push_back({plan.ptrSlots[k], plan.elemSizes[k]});
+    }
+    if (plan.lftr) ivEliminated.insert(lp.iv);
+
+    if (plan.lftr) {
+        out << lftrCmp;
+        out << " jge endwhile_" << label << endl;
+    } else {
+        stm->condition->accept(this);
+        out << " cmpq $0, %rax" << endl;
+        out << " je endwhile_" << label << endl;
+    }
+    out << " .p2align 4,,10" << endl;
+    out << "while_" << label << ":" << endl;
+    stm->b->accept(this);
+    if (plan.lftr) {
+        out << lftrCmp;
+        out << " jl while_" << label << endl;
+    } else {
+        stm->condition->accept(this);
+        out << " cmpq $0, %rax" << endl;
+        out << " jne while_" << label << endl;
+    }
+    out << "endwhile_" << label << ":" << endl;
+
+    for (auto &arr : lp.arrays) ivPointers.erase(arr + "#" + lp.iv);
+    ivBumps.erase(lp.iv);
+    ivEliminated.erase(lp.iv);
+}
+
+// Bucle c[i] = x op y vectorizado. %r8/%r9/%r10 = bases, %rcx = i, %rdx = n.
+// Se elige AVX2 (4 lanes), SSE (2 lanes) o solo escalar según __rc_simd_level
+// (1 = SSE2, 2 = SSE4.2, 3 = AVX2); la cola escalar termina las iteraciones sueltas.
+void GenCodeVisitor::emitVectorLoop(const ElementwiseLoop& ew) {
+    int label = labelcont++;
+    string L = to_string(label);
+    usesSimd = true;
+
+    auto leftNum  = dynamic_cast<NumberExp*>(ew.left);
+    auto rightNum = dynamic_cast<NumberExp*>(ew.right);
+
+    out << " cmpl $0, __rc_simd_level(%rip)\n";
+    out << " jne .Lvready_" << L << "\n";
+    out << " call __rc_detect_simd\n";
+    out << ".Lvready_" << L << ":\n";
+
+    if (!leftNum)  { ew.left->accept(this);  out << " movq %rax, %r8\n"; }
+    if (!rightNum) { ew.right->accept(this); out << " movq %rax, %r9\n"; }
+    ew.dst->accept(this);
+    out << " movq %rax, %r10\n";
+    ew.bound->accept(this);
+    out << " movq %rax, %rdx\n";
+    out << " movq " << memoria[ew.iv] << "(%rbp), %rcx\n";
+
+    string lMem = leftNum  ? "" : "(%r8,%rcx,8)";
+    string rMem = rightNum ? "" : "(%r9,%rcx,8)";
+    auto loadImm = [&](long long v) {
+        out << (fitsImm32(v) ? " movq $" : " movabsq $") << v << ", %rax\n";
+    };
+
+    // ---- AVX2: 4 elementos por iteración ----
+    out << " cmpl $3, __rc_simd_level(%rip)\n";
+    out << " jl .Lvsse_" << L << "\n";
+    if (leftNum) {
+        loadImm(leftNum->value);
+        out << " vmovq %rax, %xmm2\n";
+        out << " vpbroadcastq %xmm2, %ymm2\n";
+    }
+    if (rightNum) {
+        loadImm(rightNum->value);
+        out << " vmovq %rax, %xmm3\n";
+        out << " vpbroadcastq %xmm3, %ymm3\n";
+    }
+    out << " leaq 4(%rcx), %rax\n";
+    out << " cmpq %rdx, %rax\n";
+    out << " jg .Lvtail_" << L << "\n";
+    out << " .p2align 4,,10\n";
+    out << ".Lvavx_" << L << ":\n";
+    out << (leftNum  ? " vmovdqa %ymm2, %ymm0\n" : " vmovdqu " + lMem + ", %ymm0\n");
+    out << (rightNum ? " vmovdqa %ymm3, %ymm1\n" : " vmovdqu " + rMem + ", %ymm1\n");
+    switch (ew.op) {
+        case PLUS_OP:  out << " vpaddq %ymm1, %ymm0, %ymm0\n"; break;
+        case MINUS_OP: out << " vpsubq %ymm1, %ymm0, %ymm0\n"; break;
+        default:
+            out << " vpcmpgtq %ymm0, %ymm1, %ymm0\n";   // y > x  <=>  x < y
+            out << " vpsrlq $63, %ymm0, %ymm0\n";
+            break;
+    }
+    out << " vmovdqu %ymm0, (%r10,%rcx,8)\n";
+    out << " addq $4, %rcx\n";
+    out << " leaq 4(%rcx), %rax\n";
+    out << " cmpq %rdx, %rax\n";
+    out << " jle .Lvavx_" << L << "\n";
+    out << " vzeroupper\n";
+    out << " jmp .Lvtail_" << L << "\n";
+
+    // ---- SSE: 2 elementos por iteración (pcmpgtq necesita SSE4.2) ----
+    out << ".Lvsse_" << L << ":\n";
+    if (ew.op == LT_OP) {
+        out << " cmpl $2, __rc_simd_level(%rip)\n";
+        out << " jl .Lvtail_" << L << "\n";
+    }
+    if (leftNum) {
+        loadImm(leftNum->value);
+        out << " movq %rax, %xmm2\n";
+        out << " punpcklqdq %xmm2, %xmm2\n";
+    }
+    if (rightNum) {
+        loadImm(rightNum->value);
+        out << " movq %rax, %xmm3\n";
+        out << " punpcklqdq %xmm3, %xmm3\n";
+    }
+    out << " leaq 2(%rcx), %rax\n";
+    out << " cmpq %rdx, %rax\n";
+    out << " jg .Lvtail_" << L << "\n";
+    out << " .p2align 4,,10\n";
+    out << ".Lvsseloop_" << L << ":\n";
+    out << (leftNum  ? " movdqa %xmm2, %xmm0\n" : " movdqu " + lMem + ", %xmm0\n");
+    out << (rightNum ? " movdqa %xmm3, %xmm1\n" : " movdqu " + rMem + ", %xmm1\n");
+    switch (ew.op) {
+        case PLUS_OP:  out << " paddq %xmm1, %xmm0\n"; break;
+        case MINUS_OP: out << " psubq %xmm1, %xmm0\n"; break;
+        default:
+            out << " pcmpgtq %xmm0, %xmm1\n";
+            out << " psrlq $63, %xmm1\n";
+            out << " movdqa %xmm1, %xmm0\n";
+            break;
+    }
+    out << " movdqu %xmm0, (%r10,%rcx,8)\n";
+    out << " addq $2, %rcx\n";
+    out << " leaq 2(%rcx), %rax\n";
+    out << " cmpq %rdx, %rax\n";
+    out << " jle .Lvsseloop_" << L << "\n";
+
+    // ---- cola escalar ----
+    out << ".Lvtail_" << L << ":\n";
+    out << " cmpq %rdx, %rcx\n";
+    out << " jge .Lvend_" << L << "\n";
+    // una constante que no cabe en 32 bits va en %r11 (%rcx es el índice)
+    string rOp = rMem;
+    if (rightNum && fitsImm32(rightNum->value)) rOp = "$" + to_string(rightNum->value);
+    else if (rightNum) {
+        out << " movabsq $" << rightNum->value << ", %r11\n";
+        rOp = "%r11";
+    }
+    out << ".Lvtailloop_" << L << ":\n";
+    if (leftNum) loadImm(leftNum->value);
+    else         out << " movq " << lMem << ", %rax\n";
+    switch (ew.op) {
+        case PLUS_OP:  out << " addq " << rOp << ", %rax\n"; break;
+        case MINUS_OP: out << " subq " << rOp << ", %rax\n"; break;
+        default:
+            out << " cmpq " << rOp << ", %rax\n";
+            out << " setl %al\n";
+            out << " movzbq %al, %rax\n";
+            break;
+    }
+    out << " movq %rax, (%r10,%rcx,8)\n";
+    out << " incq %rcx\n";
+    out << " cmpq %rdx, %rcx\n";
+    out << " jl .Lvtailloop_" << L << "\n";
+    out << ".Lvend_" << L << ":\n";
+    out << " movq %rcx, " << memoria[ew.iv] << "(%rbp)\n";
+}
+
+// Detección de SIMD en tiempo de ejecución (una sola vez por proceso).
+// Solo usa registros volátiles que no son de argumentos, más %rbx (salvado).
+void GenCodeVisitor::emitSimdRuntime() {
+    out << ".data\n";
+    out << " .p2align 2\n";
+    out << "__rc_simd_level:\n";
+    out << " .long 0\n";
+    out << ".text\n";
+    out << "__rc_detect_simd:\n";
+    out << " pushq %rbx\n";
+    out << " movl $1, %r11d\n";              // SSE2: siempre en x86-64
+    out << " xorl %eax, %eax\n";
+    out << " cpuid\n";
+    out << " movl %eax, %r10d\n";            // hoja máxima
+    out << " movl $1, %eax\n";
+    out << " cpuid\n";
+    out << " testl $0x100000, %ecx\n";       // SSE4.2
+    out << " jz .Ldetect_done\n";
+    out << " movl $2, %r11d\n";
+    out << " andl $0x18000000, %ecx\n";      // OSXSAVE + AVX
+    out << " cmpl $0x18000000, %ecx\n";
+    out << " jne .Ldetect_done\n";
+    out << " cmpl $7, %r10d\n";
+    out << " jb .Ldetect_done\n";
+    out << " xorl %ecx, %ecx\n";
+    out << " xgetbv\n";                       // el SO guarda estado XMM/YMM
+    out << " andl $6, %eax\n";
+    out << " cmpl $6, %eax\n";
+    out << " jne .Ldetect_done\n";
+    out << " movl $7, %eax\n";
+    out << " xorl %ecx, %ecx\n";
+    out << " cpuid\n";
+    out << " testl $0x20, %ebx\n";           // AVX2
+    out << " jz .Ldetect_done\n";
+    out << " movl $3, %r11d\n";
+    out << ".Ldetect_done:\n";
+    out << " movl %r11d, __rc_simd_level(%rip)\n";
+    out << " popq %rbx\n";
+    out << " ret\n";
+}
+
+int GenCodeVisitor::visit(ReturnStm* stm) {
+    std::string retType = currentFunctionReturnType;
+
+    if (!isAggregateType(retType)) {
+        if (emitTailCall(stm)) return 0;
+        stm->e->accept(this);
+        if (accSlot) {
+            // resultado final = acumulado op valor
+            if (accOp == PLUS_OP) out << " addq " << accSlot << "(%rbp), %rax\n";
+            else                  out << " imulq " << accSlot << "(%rbp), %rax\n";
+        }
+        out << " jmp .end_" << nombreFuncion << "\n";
+        return 0;
+    }
+
+    // struct/array: se escribe en el destino que dio quien llama (retornoOffset);
+    // return(g(...)) le pasa ese mismo destino a g
+    string slot = to_string(retornoOffset) + "(%rbp)";
+    if (!emitResultInto(stm->e, " movq " + slot + ", %rdi")) {
+        AddrMode dst;
+        dst.base = "%rcx";
+        out << " movq " << slot << ", %rcx\n";
+        emitInit(retType, stm->e, dst);
+    }
+    out << " movq " << slot << ", %rax\n";
+    out << " jmp .end_" << nombreFuncion << "\n";
+    return 0;
+}
+
+// ---- llamadas en cola ----
+
+static bool isScalarType(const string& t) {
+    return isIntType(t) || t == "String" || t == "void";
+}
+
+static FcallExp* selfCall(Exp* e, FunDec* f) {
+    auto call = dynamic_cast<FcallExp*>(e);
+    if (!call || call->nombre != f->nombre || call->argumentos.size() != f->Pnombres.size()) {
+        return nullptr;
+    }
+    return call;
+}
+
+static void collectRefs(Exp* e, unordered_set<string>& ids);
+
+// solo lee parámetros y lets de f: nada que la llamada recursiva pueda cambiar
+static bool localOnly(Exp* e, FunDec* f) {
+    unordered_set<string> ids, locals(f->Pnombres.begin(), f->Pnombres.end());
+    collectRefs(e, ids);
+    collectLets(f->cuerpo, locals);
+    for (auto &id : ids) if (!locals.count(id)) return false;
+    return true;
+}
+
+// return(e op f(...)) o return(f(...) op e), con e sin llamadas. Con el
+// acumulador e se evalúa antes de la llamada: en f(...) op e eso solo vale si
+// e no lee statics que la llamada pueda modificar.
+static FcallExp* accumulatingCall(Exp* e, FunDec* f, BinaryOp op, Exp*& other) {
+    auto b = dynamic_cast<BinaryExp*>(e);
+    if (!b || b->hasOverloadedImpl || b->op != op) return nullptr;
+    if (auto c = selfCall(b->right, f)) {
+        if (callFree(b->left)) { other = b->left; return c; }
+    }
+    if (auto c = selfCall(b->left, f)) {
+        if (callFree(b->right) && localOnly(b->right, f)) { other = b->right; return c; }
+    }
+    return nullptr;
+}
+
+static void collectReturns(Body* b, vector<ReturnStm*>& rets) {
+    if (!b) return;
+    for (auto s : b->StmList) {
+        if (auto r = dynamic_cast<ReturnStm*>(s)) rets.push_back(r);
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            collectReturns(i->then, rets);
+            collectReturns(i->els, rets);
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) collectReturns(w->b, rets);
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            for (auto arm : m->arms) collectReturns(arm->body, rets);
+            collectReturns(m->otherwise, rets);
+        }
+    }
+}
+
+// Decide si la función se llama a sí misma en cola (return(f(...))) y si
+// conviene un acumulador para return(e + f(...)) / return(e * f(...)).
+// Con parámetros struct/array (punteros al frame) no se toca nada.
+void GenCodeVisitor::planTailCalls(FunDec* f) {
+    funActual = f;
+    tailSelf = false;
+    accSlot = 0;
+    if (f->nombre.compare(0, 5, "__op_") == 0 || !isScalarType(f->tipo)) return;
+    for (auto &t : f->Ptipos) {
+        if (!isScalarType(t)) return;
+    }
+
+    vector<ReturnStm*> rets;
+    collectReturns(f->cuerpo, rets);
+
+    bool accumulate = false;
+    for (auto r : rets) {
+        Exp* other = nullptr;
+        if (selfCall(r->e, f)) {
+            tailSelf = true;
+        } else if (f->tipo == "i64" && !accumulate) {
+            if (accumulatingCall(r->e, f, PLUS_OP, other))     { accumulate = true; accOp = PLUS_OP; }
+            else if (accumulatingCall(r->e, f, MUL_OP, other)) { accumulate = true; accOp = MUL_OP; }
+        }
+    }
+    if (accumulate) {
+        tailSelf = true;
+        offset -= 8;
+        accSlot = offset;
+    }
+}
+
+void GenCodeVisitor::emitSelfJump(FcallExp* call) {
+    // todos los argumentos se evalúan antes de pisar ningún parámetro
+    for (auto a : call->argumentos) {
+        a->accept(this);
+        out << " pushq %rax\n";
+    }
+    for (int i = (int)call->argumentos.size() - 1; i >= 0; --i) {
+        out << " popq " << memoria[funActual->Pnombres[i]] << "(%rbp)\n";
+    }
+    out << " jmp .tail_" << nombreFuncion << "\n";
+}
+
+bool GenCodeVisitor::emitTailCall(ReturnStm* stm) {
+    if (!funActual) return false;
+
+    if (tailSelf) {
+        if (auto call = selfCall(stm->e, funActual)) {
+            emitSelfJump(call);
+            return true;
+        }
+        Exp* other = nullptr;
+        FcallExp* call = accSlot ? accumulatingCall(stm->e, funActual, accOp, other) : nullptr;
+        if (call) {
+            other->accept(this);
+            if (accOp == PLUS_OP) {
+                out << " addq %rax, " << accSlot << "(%rbp)\n";
+            } else {
+                out << " imulq " << accSlot << "(%rbp), %rax\n";
+                out << " movq %rax, " << accSlot << "(%rbp)\n";
+            }
+            emitSelfJump(call);
+            return true;
+        }
+    }
+
+    // return(g(...)) a otra función: se libera el frame y se salta a g, que
+    // devuelve directamente a nuestro llamador
+    auto call = dynamic_cast<FcallExp*>(stm->e);
+    if (!call || accSlot || call->argumentos.size() > 6 || !isScalarType(currentFunctionReturnType)) {
+        return false;
+    }
+    auto itR = funcReturnTypes.find(call->nombre);
+    if (itR == funcReturnTypes.end() || !isScalarType(itR->second)) return false;
+    for (auto a : call->argumentos) {
+        if (!isIntType(a->ty) && a->ty != "String") return false;   // nada que apunte al frame
+    }
+
+    vector<string> argRegs = {"%rdi","%rsi","%rdx","%rcx","%r8","%r9"};
+    for (auto a : call->argumentos) {
+        a->accept(this);
+        out << " pushq %rax\n";
+    }
+    for (int i = (int)call->argumentos.size() - 1; i >= 0; --i) {
+        out << " popq " << argRegs[i] << "\n";
+    }
+    out << " leave\n";
+    out << " jmp " << call->nombre << "\n";
+    return true;
+}
+
+// ¿queda en el literal algo que calcular en ejecución? (todo lo que no es un número)
+static bool hasDynamicParts(Exp* e) {
+    if (!e || dynamic_cast<NumberExp*>(e)) return false;
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) if (hasDynamicParts(f.second)) return true;
+        return false;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) if (hasDynamicParts(x)) return true;
+        return false;
+    }
+    return true;
+}
+
+// pone a cero `bytes` bytes en dst: movups de 16 bytes si son pocos, rep stosq si no
+void GenCodeVisitor::emitZeroFill(int bytes, const AddrMode& dst) {
+    if (bytes <= zeroStoreMaxBytes) {
+        AddrMode f = dst;
+        if (bytes >= 16) out << " xorps %xmm0, %xmm0\n";
+        for (; bytes >= 16; bytes -= 16, f.disp += 16) out << " movups %xmm0, " << f.str() << "\n";
+        for (; bytes >= 8; bytes -= 8, f.disp += 8)    out << " movq $0, " << f.str() << "\n";
+        for (; bytes >= 4; bytes -= 4, f.disp += 4)    out << " movl $0, " << f.str() << "\n";
+        for (; bytes > 0; bytes--, f.disp++)           out << " movb $0, " << f.str() << "\n";
+        return;
+    }
+    out << " leaq " << dst.str() << ", %rdi\n";
+    out << " xorl %eax, %eax\n";
+    out << " movq $" << bytes / 8 << ", %rcx\n";
+    out << " rep stosq\n";
+    if (bytes % 8) {
+        out << " movq $" << bytes % 8 << ", %rcx\n";
+        out << " rep stosb\n";
+    }
+}
+
+// ¿puede el literal leer la memoria de dst? Un destino en el frame solo choca con
+// las variables cuyo slot se solapa; uno por %rcx o global, con cualquier
+// agregado, puntero recibido o static que se lea.
+bool GenCodeVisitor::initReadsDest(Exp* e, const AddrMode& dst, int size) {
+    unordered_set<string> ids;
+    collectRefs(e, ids);
+    bool inFrame = dst.base == "%rbp" && dst.sym.empty();
+    for (auto &id : ids) {
+        if (memoria.count(id)) {
+            if (pointerParams.count(id)) {
+                if (!inFrame) return true;
+                continue;
+            }
+            const string& vt = varTypes[id];
+            if (!inFrame) {
+                if (dst.sym.empty() && isAggregateType(vt)) return true;
+                continue;
+            }
+            int lo = memoria[id], hi = lo + (isAggregateType(vt) ? typeSize(vt) : 8);
+            if (lo < dst.disp + size && dst.disp < hi) return true;
+        }
+        else if (memoriaGlobal.count(id) && !inFrame) return true;
+    }
+    return false;
+}
+
+// Literal grande: sus números van en una imagen en .rodata que se copia de una vez
+// (si todo es cero, se rellena), y después solo se calculan los demás elementos.
+// Si esos elementos leen el propio destino, el literal se arma en un temporal y
+// se copia al final.
+void GenCodeVisitor::emitBulkInit(const string& t, Exp* e, const AddrMode& dst) {
+    bool viaRcx = dst.base == "%rcx";
+    int size = typeSize(t);
+    if (hasDynamicParts(e) && initReadsDest(e, dst, size)) {
+        AddrMode tmp;
+        tmp.base = "%rbp";
+        tmp.disp = tempSlot(size);
+        if (viaRcx) out << " pushq %rcx\n";
+        emitBulkInit(t, e, tmp);
+        if (viaRcx) out << " popq %rcx\n";
+        out << " leaq " << tmp.str() << ", %rsi\n";
+        out << " leaq " << dst.str() << ", %rdi\n";
+        emitBlockCopy(size);
+        return;
+    }
+    if (viaRcx) out << " pushq %rcx\n";
+    if (allZero(e)) {
+        emitZeroFill(size, dst);
+    } else {
+        std::stringstream image;
+        std::streambuf* prev = out.rdbuf(image.rdbuf());
+        emitData(t, e, true);
+        out.rdbuf(prev);
+
+        auto it = rodataImages.find(image.str());
+        if (it == rodataImages.end()) {
+            string lbl = ".Linit_" + to_string(rodataImages.size());
+            it = rodataImages.emplace(image.str(), lbl).first;
+            rodata << " .p2align 4\n" << lbl << ":\n" << image.str();
+        }
+        out << " leaq " << it->second << "(%rip), %rsi\n";
+        out << " leaq " << dst.str() << ", %rdi\n";
+        emitBlockCopy(size);
+    }
+    if (viaRcx) out << " popq %rcx\n";
+    if (hasDynamicParts(e)) emitInit(t, e, dst, true);
+}
+
+// Guarda `e` (de tipo t) en dst según la disposición del tipo: los literales de
+// struct/array campo a campo (lo que falta queda a 0), otro agregado se copia
+// entero y un escalar con su ancho. Si dst va por %rcx, se preserva mientras se
+// evalúan expresiones que no son hojas. Con dynamicOnly la imagen del literal ya
+// está copiada y solo se escriben las partes que no son números.
+void GenCodeVisitor::emitInit(const string& t, Exp* e, const AddrMode& dst, bool dynamicOnly) {
+    bool viaRcx = dst.base == "%rcx";
+    auto at = [&](int off) {
+        AddrMode f = dst;
+        f.disp += off;
+        return f;
+    };
+
+    auto sl = dynamic_cast<StructLitExp*>(e);
+    auto al = dynamic_cast<ArrayLitExp*>(e);
+    if (!dynamicOnly && (sl || al) && typeSize(t) >= bulkInitMinBytes) {
+        emitBulkInit(t, e, dst);
+        return;
+    }
+    if (structTable.count(t) && (sl || !e)) {
+        StructInfo &info = structTable[t];
+        unordered_map<string, Exp*> fieldExprs;
+        if (sl) {
+            for (auto &f : sl->fields) fieldExprs[f.first] = f.second;
+        }
+        for (const string &fname : info.fieldOrder) {
+            emitInit(info.fieldType[fname], fieldExprs.count(fname) ? fieldExprs[fname] : nullptr,
+                     at(info.fieldOffset[fname]), dynamicOnly);
+        }
+        return;
+    }
+    if (isArrayType(t) && (al || !e)) {
+        string elemType;
+        int len = 0;
+        parseArrayType(t, elemType, len);
+        int elemSize = typeSize(elemType);
+        for (int i = 0; i < len; ++i) {
+            emitInit(elemType, al && i < (int)al->elems.size() ? al->elems[i] : nullptr, at(i * elemSize),
+                     dynamicOnly);
+        }
+        return;
+    }
+    if (structTable.count(t) || isArrayType(t)) {
+        if (!viaRcx && dst.sym.empty() && emitResultInto(e, " leaq " + dst.str() + ", %rdi")) return;
+        if (viaRcx) out << " pushq %rcx\n";
+        e->accept(this);                       // %rax = &origen
+        if (viaRcx) out << " popq %rcx\n";
+        out << " movq %rax, %rsi\n";
+        out << " leaq " << dst.str() << ", %rdi\n";
+        emitBlockCopy(typeSize(t));
+        return;
+    }
+
+    auto num = dynamic_cast<NumberExp*>(e);
+    if (dynamicOnly && (!e || num)) return;
+    if (!e || (num && (typeSize(t) == 4 || fitsImm32(num->value)))) {
+        out << sizedMov(typeSize(t)) << " $" << (num ? num->value : 0) << ", " << dst.str() << "\n";
+        return;
+    }
+    bool keep = viaRcx && !dynamic_cast<NumberExp*>(e) && !dynamic_cast<IdExp*>(e);
+    if (keep) out << " pushq %rcx\n";
+    e->accept(this);                           // %rax = valor
+    if (keep) out << " popq %rcx\n";
+    emitStore(t, dst.str());
+}
+
+int GenCodeVisitor::visit(LetStm* exp) {
+    // Registrar tipo de la variable
+    varTypes[exp->id] = exp->type;
+
+    if (!exp->e) return 0;                     // declarada sin inicializar (inlining)
+
+    if (structTable.count(exp->type) || isArrayType(exp->type)) {   // let l: Line = Line { ... };
+        AddrMode dst;
+        dst.base = "%rbp";
+        dst.disp = memoria[exp->id];
+        emitInit(exp->type, exp->e, dst);
+        return 0;
+    }
+
+    exp->e->accept(this);                      // %rax = valor de la expresión
+    out << " movq %rax, " << memoria[exp->id] << "(%rbp)\n";
+    return 0;
+}
+
+
+// ----------------- Slots del frame: locales que comparten memoria -----------------
+
+static void collectRefs(Body* b, unordered_set<string>& ids);
+
+static void collectRefs(Stm* s, unordered_set<string>& ids) {
+    if (auto a = dynamic_cast<AssignStm*>(s)) {
+        collectRefs(a->lhs, ids);
+        collectRefs(a->e, ids);
+    }
+    else if (auto l = dynamic_cast<LetStm*>(s))    collectRefs(l->e, ids);
+    else if (auto p = dynamic_cast<PrintStm*>(s))  collectRefs(p->e, ids);
+    else if (auto r = dynamic_cast<ReturnStm*>(s)) collectRefs(r->e, ids);
+    else if (auto i = dynamic_cast<IfStm*>(s)) {
+        collectRefs(i->condition, ids);
+        collectRefs(i->then, ids);
+        collectRefs(i->els, ids);
+    }
+    else if (auto w = dynamic_cast<WhileStm*>(s)) {
+        collectRefs(w->condition, ids);
+        collectRefs(w->b, ids);
+    }
+    else if (auto m = dynamic_cast<MatchStm*>(s)) {
+        collectRefs(m->scrutinee, ids);
+        for (auto arm : m->arms) collectRefs(arm->body, ids);
+        collectRefs(m->otherwise, ids);
+    }
+    else if (auto fs = dynamic_cast<FcallStm*>(s)) collectRefs(fs->call, ids);
+}
+
+static void collectRefs(Body* b, unordered_set<string>& ids) {
+    if (!b) return;
+    for (auto v : b->vars) collectRefs(v->e, ids);
+    for (auto s : b->StmList) collectRefs(s, ids);
+}
+
+static void collectRefs(Exp* e, unordered_set<string>& ids) {
+    if (!e) return;
+    if (auto id = dynamic_cast<IdExp*>(e)) ids.insert(id->value);
+    else if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        collectRefs(b->left, ids);
+        collectRefs(b->right, ids);
+    }
+    else if (auto f = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : f->argumentos) collectRefs(a, ids);
+    }
+    else if (auto fa = dynamic_cast<FieldAccessExp*>(e)) collectRefs(fa->base, ids);
+    else if (auto ix = dynamic_cast<IndexExp*>(e)) {
+        collectRefs(ix->array, ids);
+        collectRefs(ix->index, ids);
+    }
+    else if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) collectRefs(f.second, ids);
+    }
+    else if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) collectRefs(x, ids);
+    }
+    else if (auto c = dynamic_cast<CastExp*>(e)) collectRefs(c->e, ids);
+}
+
+// inicializador que no lee variables: puede evaluarse justo antes del primer uso
+static bool constantInit(Exp* e) {
+    if (dynamic_cast<NumberExp*>(e) || dynamic_cast<StringExp*>(e)) return true;
+    if (auto sl = dynamic_cast<StructLitExp*>(e)) {
+        for (auto &f : sl->fields) if (!constantInit(f.second)) return false;
+        return true;
+    }
+    if (auto al = dynamic_cast<ArrayLitExp*>(e)) {
+        for (auto x : al->elems) if (!constantInit(x)) return false;
+        return true;
+    }
+    return false;
+}
+
+// Coloreado de slots: dos let del nivel superior cuyas vidas no se solapan usan el
+// mismo hueco del frame (también arrays y structs). La vida se mide en índices de
+// sentencias del cuerpo; -1 es la entrada, donde se evalúan los inicializadores,
+// y un bucle cuenta como una sola sentencia, así que cubre todos sus usos. Los let
+// con inicializador constante se inicializan justo antes de la sentencia que los
+// usa primero (letsBefore), así su vida no empieza en la entrada. Los parámetros y
+// los slots de los bucles y del acumulador no se comparten.
+// Devuelve los bytes que ocuparían los locales sin compartir.
+int GenCodeVisitor::assignLetSlots(Body* b) {
+    struct Live {
+        int start = -1, end = -1;    // sentencias donde se usa por primera/última vez
+        int size = 0;
+        bool align16 = false;
+        bool seen = false;
+    };
+    unordered_map<string, Live> live;
+    unordered_map<string, int> decls;
+    vector<string> order;
+
+    for (auto v : b->vars) decls[v->id]++;
+    deferredLets.clear();
+    letsBefore.assign(b->StmList.size(), {});
+
+    int naive = offset;
+    for (auto v : b->vars) {
+        varTypes[v->id] = v->type;
+        int size = getTypeSize(v->type);
+        bool align16 = isArrayType(v->type) && size >= 16;
+        naive -= size;
+        if (align16) naive = -((-naive + 15) / 16 * 16);
+
+        if (!live.count(v->id)) order.push_back(v->id);
+        Live& l = live[v->id];
+        l.size = max(l.size, size);
+        l.align16 = l.align16 || align16;
+        if (v->e && decls[v->id] == 1 && constantInit(v->e)) {
+            deferredLets.insert(v);
+        } else if (v->e) {
+            l.seen = true;                  // vive desde la entrada
+        }
+    }
+
+    auto touch = [&](const unordered_set<string>& ids, int idx) {
+        for (auto& id : ids) {
+            auto it = live.find(id);
+            if (it == live.end()) continue;
+            Live& l = it->second;
+            if (!l.seen) { l.start = idx; l.seen = true; }
+            l.end = max(l.end, idx);
+        }
+    };
+    unordered_set<string> ids;
+    for (auto v : b->vars) collectRefs(v->e, ids);
+    touch(ids, -1);
+    vector<Stm*> stms(b->StmList.begin(), b->StmList.end());
+    int idx = 0;
+    for (auto s : b->StmList) {
+        ids.clear();
+        collectRefs(s, ids);
+        touch(ids, idx++);
+    }
+    for (auto v : b->vars) {
+        if (!deferredLets.count(v)) continue;
+        Live& l = live[v->id];
+        if (!l.seen) continue;                      // sin usos: no se inicializa
+        if (l.start < 0) {
+            deferredLets.erase(v);                  // lo lee otro inicializador
+            continue;
+        }
+        // si el primer uso lo sobrescribe entero, el valor inicial está muerto
+        auto a = dynamic_cast<AssignStm*>(stms[l.start]);
+        auto lhs = a ? dynamic_cast<IdExp*>(a->lhs) : nullptr;
+        if (lhs && lhs->value == v->id && !isArrayType(v->type) && !structTable.count(v->type)) {
+            ids.clear();
+            collectRefs(a->e, ids);
+            if (!ids.count(v->id)) continue;
+        }
+        letsBefore[l.start].push_back(v);
+    }
+
+    stable_sort(order.begin(), order.end(), [&](const string& x, const string& y) {
+        if (live[x].start != live[y].start) return live[x].start < live[y].start;
+        return live[x].size > live[y].size;
+    });
+
+    struct Slot { int off, size, freeAfter; };
+    vector<Slot> slots;
+    for (auto& name : order) {
+        Live& l = live[name];
+        int best = -1;
+        for (size_t i = 0; i < slots.size(); i++) {
+            Slot& s = slots[i];
+            if (s.freeAfter >= l.start || s.size < l.size) continue;
+            if (l.align16 && s.off % 16 != 0) continue;
+            if (best < 0 || s.size < slots[best].size) best = i;
+        }
+        if (best < 0) {
+            offset -= l.size;
+            if (l.align16) offset = -((-offset + 15) / 16 * 16);   // %rbp está alineado a 16
+            slots.push_back({offset, l.size, l.end});
+            memoria[name] = offset;
+        } else {
+            slots[best].freeAfter = l.end;
+            memoria[name] = slots[best].off;
+        }
+    }
+    return offset - naive;
+}
+
+// ----------------- Marcos: red zone y shrink-wrapping -----------------
+
+// N(%rbp) -> (N-8)(%rsp): sin marco, el %rbp "virtual" es el %rsp de entrada - 8,
+// así las alineaciones de los locales no cambian.
+static string rebaseFrame(const string& line) {
+    size_t pos = line.find("(%rbp");
+    if (pos == string::npos) return line;
+    size_t start = pos;
+    while (start > 0 && (isdigit(line[start - 1]) || line[start - 1] == '-')) start--;
+    int disp = start < pos ? stoi(line.substr(start, pos - start)) : 0;
+    return line.substr(0, start) + to_string(disp - 8) + "(%rsp" + line.substr(pos + 5);
+}
+
+// Reescribe código generado con marco para ejecutarse en la red zone (128 bytes bajo
+// %rsp que el ABI garantiza a las funciones hoja). `used` son los bytes de locales;
+// los pushq/popq de la pila de expresiones pasan a huecos fijos debajo de ellos, ya
+// que %rsp no se mueve. Falla si hay llamadas o si no cabe.
+static bool toRedZone(const string& code, int used, string& res) {
+    vector<string> lines;
+    istringstream in(code);
+    string line;
+    int depth = 0, maxDepth = 0;
+    while (getline(in, line)) {
+        if (line.find("call") != string::npos || line.find("%rsp") != string::npos) return false;
+        size_t rbp = line.find("%rbp");
+        if (rbp != string::npos && (rbp == 0 || line[rbp - 1] != '(')) return false;
+        if (line.find("pushq") != string::npos) maxDepth = max(maxDepth, ++depth);
+        if (line.find("popq") != string::npos) depth--;
+        lines.push_back(line);
+    }
+    if (8 + used + 8 * maxDepth > 128) return false;
+
+    auto slot = [&](int d) { return to_string(-(used + 8 * (d + 1)) - 8) + "(%rsp)"; };
+    ostringstream o;
+    depth = 0;
+    for (auto& l : lines) {
+        string r = rebaseFrame(l);
+        size_t first = r.find_first_not_of(' ');
+        string mnem = first == string::npos ? "" : r.substr(first, r.find(' ', first) - first);
+        string arg  = mnem.empty() || r.find(' ', first) == string::npos ? "" : r.substr(r.find(' ', first) + 1);
+        if (mnem == "leave") continue;
+        if (mnem == "pushq") {
+            if (arg.find('(') != string::npos) {
+                o << " movq " << arg << ", %r11\n";
+                arg = "%r11";
+            }
+            o << " movq " << arg << ", " << slot(depth++) << "\n";
+        }
+        else if (mnem == "popq") {
+            if (arg.find('(') != string::npos) {
+                o << " movq " << slot(--depth) << ", %r11\n";
+                o << " movq %r11, " << arg << "\n";
+            } else {
+                o << " movq " << slot(--depth) << ", " << arg << "\n";
+            }
+        }
+        else o << r << "\n";
+    }
+    res = o.str();
+    return true;
+}
+
+// ¿hay alguna asignación a `name` o a una parte suya (name.f, name[i]) en el cuerpo?
+static bool assignsTo(Body* b, const string& name) {
+    if (!b) return false;
+    for (auto s : b->StmList) {
+        if (auto a = dynamic_cast<AssignStm*>(s)) {
+            Exp* root = a->lhs;
+            for (;;) {
+                if (auto fa = dynamic_cast<FieldAccessExp*>(root)) root = fa->base;
+                else if (auto ix = dynamic_cast<IndexExp*>(root)) root = ix->array;
+                else break;
+            }
+            auto id = dynamic_cast<IdExp*>(root);
+            if (id && id->value == name) return true;
+        }
+        else if (auto i = dynamic_cast<IfStm*>(s)) {
+            if (assignsTo(i->then, name) || assignsTo(i->els, name)) return true;
+        }
+        else if (auto w = dynamic_cast<WhileStm*>(s)) {
+            if (assignsTo(w->b, name)) return true;
+        }
+        else if (auto m = dynamic_cast<MatchStm*>(s)) {
+            for (auto arm : m->arms) if (assignsTo(arm->body, name)) return true;
+            if (assignsTo(m->otherwise, name)) return true;
+        }
+    }
+    return false;
+}
+
+// expresión sin llamadas que solo lee parámetros escalares
+static bool paramOnly(Exp* e, const unordered_set<string>& params) {
+    if (dynamic_cast<NumberExp*>(e)) return true;
+    if (auto id = dynamic_cast<IdExp*>(e)) return params.count(id->value) > 0;
+    if (auto b = dynamic_cast<BinaryExp*>(e)) {
+        return !b->hasOverloadedImpl && paramOnly(b->left, params) && paramOnly(b->right, params);
+    }
+    return false;
+}
+
+// Shrink-wrapping: si el cuerpo empieza por `if (c) { return(e) }` con c y e sobre
+// parámetros, esa salida rápida se evalúa antes del prólogo (en la red zone) y
+// retorna sin montar el marco. Los parámetros quedan guardados justo donde el
+// prólogo los espera, así que el camino lento continúa sin volver a copiarlos.
+bool GenCodeVisitor::emitFastPath(FunDec* f, string& code) {
+    if (f->cuerpo->StmList.empty() || f->tipo == "void") return false;
+    auto guard = dynamic_cast<IfStm*>(f->cuerpo->StmList.front());
+    if (!guard || (guard->els && !guard->els->StmList.empty())) return false;
+    if (!guard->then->vars.empty() || guard->then->StmList.size() != 1) return false;
+    auto ret = dynamic_cast<ReturnStm*>(guard->then->StmList.front());
+    if (!ret || !ret->e || !isScalarType(f->tipo)) return false;
+    // los lets se inicializan al entrar: la ruta rápida no puede saltarse una llamada
+    for (auto v : f->cuerpo->vars) {
+        if (!callFree(v->e)) return false;
+    }
+    for (auto &t : f->Ptipos) {
+        if (!isScalarType(t)) return false;     // un registro por parámetro
+    }
+
+    unordered_set<string> params;
+    for (size_t i = 0; i < f->Pnombres.size(); i++) {
+        if (isScalarType(f->Ptipos[i])) params.insert(f->Pnombres[i]);
+    }
+    if (!paramOnly(guard->condition, params) || !paramOnly(ret->e, params)) return false;
+
+    vector<string> argRegs = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
+    ostringstream fast;
+    streambuf* saved = out.rdbuf(fast.rdbuf());
+    for (size_t i = 0; i < f->Pnombres.size(); i++) {
+        out << " movq " << argRegs[i] << ", " << memoria[f->Pnombres[i]] << "(%rbp)\n";
+    }
+    guard->condition->accept(this);
+    out << " cmpq $0, %rax\n";
+    out << " je .frame_" << f->nombre << "\n";
+    ret->e->accept(this);
+    out.rdbuf(saved);
+
+    string rz;
+    if (!toRedZone(fast.str(), 8 * f->Pnombres.size(), rz)) return false;
+    code = rz + " ret\n.frame_" + f->nombre + ":\n";
+    return true;
+}
+
+int GenCodeVisitor::visit(FunDec* f) {
+    entornoFuncion = true;
+    memoria.clear();
+    offset = 0;        
+    nombreFuncion = f->nombre;
+
+    vector<string> argRegs = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
+
+    funcReturnTypes[f->nombre] = f->tipo;
+    currentFunctionReturnType = f->tipo;  
 
     out << ".globl " << f->nombre << endl;
     out << f->nombre <<  ":" << endl;
-    out << " pushq %rbp" << endl;
-    out << " movq %rsp, %rbp" << endl;
+
+    // El cuerpo se genera aparte: el prólogo depende de si la función resulta
+    // ser una hoja que cabe en la red zone.
+    ostringstream spills, body;
+    streambuf* fnOut = out.rdbuf(spills.rdbuf());
 
     for (size_t i = 0; i < f->Pnombres.size(); i++) {
         varTypes[f->Pnombres[i]] = f->Ptipos[i];
     }
 
+    // resultado struct/array: %rdi trae el destino y los parámetros empiezan en %rsi
+    int first = 0;
+    retornoOffset = 0;
+    if (isAggregateType(f->tipo)) {
+        offset -= 8;
+        retornoOffset = offset;
+        out << " movq %rdi, " << offset << "(%rbp)" << endl;
+        first = 1;
+    }
+
+    // parámetros según classifyParams: un agregado por valor se guarda entero en el
+    // frame; por referencia se guarda su dirección y, si la función lo modifica, se
+    // copia a un espacio propio
+    vector<ParamPass> passes = classifyParams(f->Ptipos, first);
+    vector<pair<int, int>> copies;             // (parámetro, slot con la dirección)
+    pointerParams.clear();
+    int reg = first;
     int nargs = f->Pnombres.size();
     for (int i = 0; i < nargs; i++) {
-        offset -= 8;
-        memoria[f->Pnombres[i]] = offset;
-        out << " movq " << argRegs[i] << ", " << offset << "(%rbp)" << endl;
+        const string& name = f->Pnombres[i];
+        int regs = paramRegs(passes[i], f->Ptipos[i]);
+        offset -= 8 * regs;
+        memoria[name] = offset;
+        for (int k = 0; k < regs; k++) {
+            out << " movq " << argRegs[reg + k] << ", " << offset + 8 * k << "(%rbp)" << endl;
+        }
+        reg += regs;
+        if (passes[i] == ParamPass::Reference) {
+            if (assignsTo(f->cuerpo, name)) copies.push_back({i, offset});
+            else pointerParams.insert(name);
+        }
+    }
+    for (auto &c : copies) {
+        int size = typeSize(f->Ptipos[c.first]);
+        offset -= (size + 7) / 8 * 8;
+        memoria[f->Pnombres[c.first]] = offset;
+        out << " movq " << c.second << "(%rbp), %rsi" << endl;
+        out << " leaq " << offset << "(%rbp), %rdi" << endl;
+        emitBlockCopy(size);
     }
 
  
-    countStruct = true;
-    for (auto decl : f->cuerpo->vars) {
-        decl->accept(this);   
-    }
-    countStruct = false;
+    // offsets de los let (los que no se solapan comparten slot)
+    int shared = assignLetSlots(f->cuerpo);
 
-    int frameSize = -offset;      // offset es <= 0
-    if (frameSize % 16 != 0) {
-        frameSize += (16 - (frameSize % 16));
-    }
+    ivPlans.clear();
+    planInductionLoops(f->cuerpo, f->cuerpo);
+    planTailCalls(f);
+
+    tempBase = offset;
+    tempUsed = tempMax = 0;
+
+    out.rdbuf(body.rdbuf());
 
-    if (frameSize > 0) {
-        out << " subq $" << frameSize << ", %rsp" << endl;
+    // las llamadas en cola a sí misma vuelven aquí: los let se reinicializan
+    if (accSlot) {
+        out << " movq $" << (accOp == PLUS_OP ? 0 : 1) << ", " << accSlot << "(%rbp)" << endl;
+    }
+    if (tailSelf) {
+        out << ".tail_" << f->nombre << ":" << endl;
     }
 
     for (auto decl : f->cuerpo->vars) {
-        decl->accept(this);      
+        tempUsed = 0;
+        if (!deferredLets.count(decl)) decl->accept(this);
     }
 
     // cuerpo
+    size_t idx = 0;
     for (auto s : f->cuerpo->StmList) {
+        for (auto decl : letsBefore[idx++]) {
+            tempUsed = 0;
+            decl->accept(this);
+        }
+        tempUsed = 0;
         s->accept(this);
     }
 
-    out << ".end_"<< f->nombre << ":"<< endl;
-    out << "leave" << endl;
-    out << "ret" << endl;
+    out.rdbuf(fnOut);
+
+    // los temporales de resultados (el mayor uso de una sentencia) van tras los locales
+    offset = tempBase - tempMax;
+    int frameSize = -offset;      // offset es <= 0
+    if (frameSize % 16 != 0) {
+        frameSize += (16 - (frameSize % 16));
+    }
+
+    int before = ((-offset + shared) + 15) / 16 * 16;
+    out << "# frame " << f->nombre << ": " << before << " -> " << frameSize << " bytes" << endl;
+
+    string leaf, fastPath;
+    if (toRedZone(spills.str() + body.str(), -offset, leaf)) {
+        out << leaf;
+        out << ".end_"<< f->nombre << ":"<< endl;
+        out << "ret" << endl;
+    } else {
+        bool wrapped = emitFastPath(f, fastPath);
+        out << fastPath;
+        out << " pushq %rbp" << endl;
+        out << " movq %rsp, %rbp" << endl;
+        if (frameSize > 0) {
+            out << " subq $" << frameSize << ", %rsp" << endl;
+        }
+        if (!wrapped) out << spills.str();
+        out << body.str();
+        out << ".end_"<< f->nombre << ":"<< endl;
+        out << "leave" << endl;
+        out << "ret" << endl;
+    }
     entornoFuncion = false;
+    funActual = nullptr;
+    tailSelf = false;
+    accSlot = 0;
     return 0;
 }
 
 int GenCodeVisitor::visit(FcallExp* exp) {
-    vector<string> argRegs = {"%rdi","%rsi","%rdx","%rcx","%r8","%r9"};
-
     std::string retType = returnTypeOfFunction(exp->nombre);
 
-    bool returnsArray = isArrayType(retType);
+    // resultado struct/array: destino en %rdi, se toma antes de evaluar los argumentos
+    bool sret = isAggregateType(retType);
+    string dest = sret ? resultDest(typeSize(retType)) : "";
 
-    // Si la función retorna array, reservar espacio
-    if (returnsArray) {
-        int size = getTypeSize(retType);
-        out << " subq $" << size << ", %rsp\n";   
-        out << " movq %rsp, %rdi\n";             
-    }
+    emitCallArgs(exp->argumentos, funcParamTypes[exp->nombre], sret ? 1 : 0);
+    if (sret) out << dest << "\n";
 
+    out << " call " << exp->nombre << "\n";
+    g_lastType = retType;          // f(...).campo y f(...)[i] necesitan el tipo
+
+    return 0;
+}
 
-    int start = returnsArray ? 1 : 0;
+bool GenCodeVisitor::producesAggregate(Exp* e) {
+    if (auto call = dynamic_cast<FcallExp*>(e)) return isAggregateType(returnTypeOfFunction(call->nombre));
+    auto b = dynamic_cast<BinaryExp*>(e);
+    return b && b->hasOverloadedImpl && isAggregateType(b->ty);
+}
 
-    for (int i = 0; i < (int)exp->argumentos.size(); i++) {
-        exp->argumentos[i]->accept(this);  // %rax = valor
-        out << " movq %rax, " << argRegs[i + start] << "\n";
+// ¿recibe el callee algún agregado ya existente por referencia? Entonces podría
+// leerlo mientras escribe el resultado, y el destino no puede ser una variable.
+bool GenCodeVisitor::passesAggregate(Exp* e) {
+    auto byRef = [&](Exp* a) {
+        if (producesAggregate(a)) return false;                // temporal propio
+        if (auto id = dynamic_cast<IdExp*>(a)) return isAggregateType(varTypes[id->value]);
+        if (a->ty.empty()) return dynamic_cast<FieldAccessExp*>(a) || dynamic_cast<IndexExp*>(a);
+        return isAggregateType(a->ty);
+    };
+    if (auto call = dynamic_cast<FcallExp*>(e)) {
+        for (auto a : call->argumentos) if (byRef(a)) return true;
+        return false;
     }
+    auto b = static_cast<BinaryExp*>(e);
+    return byRef(b->left) || byRef(b->right);
+}
 
-    out << " call " << exp->nombre << "\n";
+// Llamada con resultado agregado escrita directamente en el destino que deja `lea`
+// en %rdi, sin temporal ni copia. Falso si no se puede (y no emite nada).
+bool GenCodeVisitor::emitResultInto(Exp* e, const string& lea) {
+    if (!producesAggregate(e) || passesAggregate(e)) return false;
+    sretLea = lea;
+    e->accept(this);
+    return true;
+}
 
-    return 0;
+// Instrucción que deja en %rdi el destino del resultado de la llamada en curso: el
+// pedido por emitResultInto o un temporal del frame, vivo hasta fin de sentencia.
+string GenCodeVisitor::resultDest(int bytes) {
+    if (!sretLea.empty()) {
+        string lea = sretLea;
+        sretLea.clear();
+        return lea;
+    }
+    return " leaq " + to_string(tempSlot(bytes)) + "(%rbp), %rdi";
 }
 
-int GenCodeVisitor::visit(StructLitExp* exp) {
-    if (structVar) {
+// temporal del frame vivo hasta el final de la sentencia
+int GenCodeVisitor::tempSlot(int bytes) {
+    tempUsed += (bytes + 15) / 16 * 16;
+    tempMax = std::max(tempMax, tempUsed);
+    return tempBase - tempUsed;
+}
 
-        StructInfo &info = structTable[exp->nombre];
+// ¿vive `e` (x, x.f, x[i]...) dentro de un static?
+bool GenCodeVisitor::inStatic(Exp* e) {
+    for (;;) {
+        if (auto fa = dynamic_cast<FieldAccessExp*>(e)) e = fa->base;
+        else if (auto ix = dynamic_cast<IndexExp*>(e)) e = ix->array;
+        else break;
+    }
+    auto id = dynamic_cast<IdExp*>(e);
+    return id && memoriaGlobal.count(id->value) && !memoria.count(id->value);
+}
 
-        unordered_map<string, Exp*> fieldExprs;
-        for (auto &f : exp->fields) {
-            fieldExprs[f.first] = f.second;
-        }
+// %rax = dirección de un argumento struct/array; un literal se construye antes en
+// un temporal. Un static pasado por referencia también se copia a un temporal: el
+// callee no lo copia si no asigna el parámetro, pero podría escribir el static.
+void GenCodeVisitor::emitArgAddress(Exp* a, const string& t, bool byRef) {
+    if (dynamic_cast<StructLitExp*>(a) || dynamic_cast<ArrayLitExp*>(a)) {
+        AddrMode dst;
+        dst.base = "%rbp";
+        dst.disp = tempSlot(typeSize(t));
+        emitInit(t, a, dst);
+        out << " leaq " << dst.str() << ", %rax\n";
+        return;
+    }
+    a->accept(this);
+    if (byRef && inStatic(a)) {
+        int tmp = tempSlot(typeSize(t));
+        out << " movq %rax, %rsi\n";
+        out << " leaq " << tmp << "(%rbp), %rdi\n";
+        emitBlockCopy(typeSize(t));
+        out << " leaq " << tmp << "(%rbp), %rax\n";
+    }
+}
 
-        for (const std::string &fname : info.fieldOrder) {
-            Exp *fe = nullptr;
-            if (fieldExprs.count(fname)) {
-                fe = fieldExprs[fname];
-            }
+// Argumentos en sus registros según classifyParams, a partir de firstReg. Cada uno
+// deja en %rax su valor o, si es un agregado, su dirección; uno por valor en
+// registros se carga de ahí en trozos de 8 bytes. Si evaluar un argumento posterior
+// puede pisar los registros de uno anterior (una llamada, o %rcx/%rdx en cualquier
+// expresión que no es una hoja), el anterior espera en la pila.
+void GenCodeVisitor::emitCallArgs(const vector<Exp*>& args, const vector<string>& types, int firstReg) {
+    static const char* regs64[] = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
+    static const char* regs32[] = {"%edi", "%esi", "%edx", "%ecx", "%r8d", "%r9d"};
+    int n = args.size();
+    vector<string> ts(types);
+    ts.resize(n, "i64");
+    vector<ParamPass> passes = classifyParams(ts, firstReg);
+
+    vector<int> first(n);
+    int reg = firstReg;
+    for (int i = 0; i < n; i++) {
+        first[i] = reg;
+        reg += paramRegs(passes[i], ts[i]);
+    }
+    if (reg > numArgRegs) throw std::runtime_error("Demasiados argumentos en la llamada");
+
+    vector<bool> stacked(n, false);
+    bool clobberAll = false, clobberRcxRdx = false;     // por los argumentos posteriores
+    for (int i = n - 1; i >= 0; i--) {
+        bool usesRcxRdx = false;
+        for (int r = first[i]; r < first[i] + paramRegs(passes[i], ts[i]); r++) {
+            usesRcxRdx |= r == 2 || r == 3;
+        }
+        stacked[i] = clobberAll || (clobberRcxRdx && usesRcxRdx);
+        Exp* a = args[i];
+        bool literal = dynamic_cast<StructLitExp*>(a) || dynamic_cast<ArrayLitExp*>(a);
+        bool copied = passes[i] == ParamPass::Reference && inStatic(a);   // emitBlockCopy
+        clobberAll |= literal || copied || !callFree(a);
+        clobberRcxRdx |= !dynamic_cast<NumberExp*>(a) && !dynamic_cast<IdExp*>(a);
+    }
 
-            if (fe) {
-                fe->accept(this);   
-            } else {
-                out << ".quad 0" << endl;
-            }
+    // src = dirección del agregado (por defecto, la que quedó en %rax)
+    auto place = [&](int i, AddrMode src) {
+        if (passes[i] != ParamPass::Registers) {
+            out << " movq %rax, " << regs64[first[i]] << "\n";
+            return;
         }
-    } else {
+        int size = typeSize(ts[i]);
+        for (int off = 0, r = first[i]; off < size; off += 8, r++, src.disp += 8) {
+            int chunk = std::min(8, size - off);
+            if (chunk == 8)      out << " movq " << src.str() << ", " << regs64[r] << "\n";
+            else if (chunk == 4) out << " movl " << src.str() << ", " << regs32[r] << "\n";
+            else if (chunk == 2) out << " movzwl " << src.str() << ", " << regs32[r] << "\n";
+            else                 out << " movzbl " << src.str() << ", " << regs32[r] << "\n";
+        }
+    };
+    AddrMode inRax;
+    inRax.base = "%rax";
+
+    for (int i = 0; i < n; i++) {
+        // variable local o global: sus trozos se cargan directamente de su dirección
+        auto id = dynamic_cast<IdExp*>(args[i]);
+        if (passes[i] == ParamPass::Registers && !stacked[i] && id && !pointerParams.count(id->value)) {
+            AddrMode am;
+            selectAddress(id, am);
+            place(i, am);
+            continue;
+        }
+        if (passes[i] == ParamPass::Scalar) args[i]->accept(this);
+        else emitArgAddress(args[i], ts[i], passes[i] == ParamPass::Reference);
+        if (stacked[i]) out << " pushq %rax\n";
+        else place(i, inRax);
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        if (!stacked[i]) continue;
+        out << " popq %rax\n";
+        place(i, inRax);
+    }
+}
 
+int GenCodeVisitor::visit(StructLitExp* exp) {
+    if (structVar) {
+        structVar = false;
+        emitData(exp->nombre, exp);     // struct anidado en .data
+        structVar = true;
     }
     return 0;
 }
 
 int GenCodeVisitor::visit(FieldAccessExp* exp) {
-    exp->base->accept(this);
-    
-    string baseType = g_lastType;
-    StructInfo& info = structTable[baseType];
-    int offset = info.fieldOffset[exp->field];
-    
-    out << " addq $" << offset << ", %rax" << endl;
-    
-    g_lastType = info.fieldType[exp->field];
-    
-    if (!structTable.count(g_lastType)) {
+    AddrMode am;
+    string fieldType = selectAddress(exp, am);
+
+    if (!structTable.count(fieldType) && !isArrayType(fieldType)) {
         // escalar
-        out << " movq (%rax), %rax" << endl;
+        emitLoad(fieldType, am.str());
+    } else {
+        emitAddress(am, "%rax");
     }
-    
+    g_lastType = fieldType;
     return 0;
 }
 
@@ -817,26 +2299,7 @@ int GenCodeVisitor::visit(StructField* exp) {
 }
 
 int GenCodeVisitor::visit(StructDec* exp) {
-
-    StructInfo info;
-    int idx = 0;
-    auto itType = exp->body->types.begin();
-
-    for (auto& name : exp->body->atributes) {
-
-        info.fieldOrder.push_back(name);
-        info.fieldOffset[name] = idx;
-        info.fieldType[name] = *itType;
-
-        int fieldSize = getTypeSize(*itType);
-
-        idx += fieldSize;
-        ++itType;
-    }
-
-    info.totalSize = idx;                 
-
-    structTable[exp->nombre] = std::move(info);
+    layoutStruct(exp);          // ya dispuesto por el typechecker
     return 0;
 }
 
@@ -853,69 +2316,142 @@ int GenCodeVisitor::visit(ArrayLitExp* exp) {
     return 0;
 }
 
-string GenCodeVisitor::emitLValueAddress(Exp* lhs) {
-    if (auto id = dynamic_cast<IdExp*>(lhs)) {
-        std::string name = id->value;
-        std::string t = varTypes[name]; 
+string GenCodeVisitor::AddrMode::str() const {
+    if (!sym.empty()) {
+        if (disp == 0) return sym + "(%rip)";
+        return sym + (disp > 0 ? "+" : "") + std::to_string(disp) + "(%rip)";
+    }
+    std::string s = disp ? std::to_string(disp) : "";
+    s += "(" + base;
+    if (!index.empty()) s += "," + index + "," + std::to_string(scale);
+    return s + ")";
+}
+
+void GenCodeVisitor::emitAddress(const AddrMode& am, const string& reg) {
+    if (am.sym.empty() && am.index.empty() && am.disp == 0 && am.base != "%rbp") {
+        if (am.base != reg) out << " movq " << am.base << ", " << reg << endl;
+        return;
+    }
+    out << " leaq " << am.str() << ", " << reg << endl;
+}
 
-        bool isGlobal = memoriaGlobal.count(name);
+// Calcula la dirección de una variable, campo o elemento como un único operando
+// disp(base,index,scale). Los offsets de frame, de campo y los índices constantes
+// se pliegan en el desplazamiento; sólo se emite código para lo que no es constante.
+// La base calculada queda en %rax o %rcx y el índice en %rax.
+string GenCodeVisitor::selectAddress(Exp* e, AddrMode& am) {
+    if (auto id = dynamic_cast<IdExp*>(e)) {
+        std::string name = id->value;
+        std::string t = varTypes[name];
 
-        if (isGlobal) {
-            out << " leaq " << name << "(%rip), %rcx\n";
+        if (memoriaGlobal.count(name) && !memoria.count(name)) {
+            am.sym = name;
         } else {
             if (!memoria.count(name)) {
                 std::cerr << "[GenCode] ERROR: variable local '" << name
                         << "' no tiene offset asignado\n";
                 throw std::runtime_error("Offset faltante para variable local");
-
             }
-            out << " leaq " << memoria[name] << "(%rbp), %rcx\n";
+            if (pointerParams.count(name) && isAggregateType(t)) {
+                out << " movq " << memoria[name] << "(%rbp), %rax" << endl;
+                am.base = "%rax";
+            } else {
+                am.base = "%rbp";
+                am.disp = memoria[name];
+            }
         }
 
         g_lastType = t;
         return t;
     }
 
-    if (auto fa = dynamic_cast<FieldAccessExp*>(lhs)) {
-        std::string baseType = emitLValueAddress(fa->base);  
+    if (auto fa = dynamic_cast<FieldAccessExp*>(e)) {
+        std::string baseType = selectAddress(fa->base, am);
 
         StructInfo &info = structTable[baseType];
-        int off = info.fieldOffset[fa->field];
-
-        out << " addq $" << off << ", %rcx" << endl;
+        am.disp += info.fieldOffset[fa->field];
 
         std::string t = info.fieldType[fa->field];
         g_lastType = t;
         return t;
     }
 
-    if (auto ix = dynamic_cast<IndexExp*>(lhs)) {
-        std::string arrType = emitLValueAddress(ix->array);
-
+    if (auto ix = dynamic_cast<IndexExp*>(e)) {
         std::string elemType;
         int len = 0;
+
+        int ptrSlot;
+        if (ivPointerSlot(ix, ptrSlot)) {
+            parseArrayType(varTypes[static_cast<IdExp*>(ix->array)->value], elemType, len);
+            out << " movq " << ptrSlot << "(%rbp), %rax" << endl;
+            am.base = "%rax";
+            g_lastType = elemType;
+            return elemType;
+        }
+
+        std::string arrType = selectAddress(ix->array, am);
         if (isArrayType(arrType)) {
             parseArrayType(arrType, elemType, len);
         } else {
             elemType = arrType;
         }
+        int elemSize = typeSize(elemType);
+        g_lastType = elemType;
 
-        // Guardar base
-        out << " movq %rcx, %rdx" << endl;   
+        // a[k] y a[i ± k]: la parte constante va al desplazamiento
+        Exp* idx = ix->index;
+        if (auto n = dynamic_cast<NumberExp*>(idx)) {
+            am.disp += n->value * elemSize;
+            return elemType;
+        }
+        if (auto bin = dynamic_cast<BinaryExp*>(idx)) {
+            auto k = dynamic_cast<NumberExp*>(bin->right);
+            if (k && !bin->hasOverloadedImpl && !isNarrowInt(bin->ty) &&
+                (bin->op == PLUS_OP || bin->op == MINUS_OP)) {
+                am.disp += (bin->op == PLUS_OP ? k->value : -k->value) * elemSize;
+                idx = bin->left;
+            }
+        }
 
-        // índice en %rax
-        ix->index->accept(this);            
+        // el índice va en %rax: la base no puede estar ahí, ni ser %rip, ni tener ya índice
+        if (!am.index.empty() || !am.sym.empty() || am.base == "%rax") {
+            emitAddress(am, "%rcx");
+            am = AddrMode();
+            am.base = "%rcx";
+        }
 
-        int elemSize = getTypeSize(elemType);
-        out << " imulq $" << elemSize << ", %rax" << endl;
-        out << " addq %rax, %rdx" << endl;
-        out << " movq %rdx, %rcx" << endl;   
+        bool leaf = dynamic_cast<NumberExp*>(idx) || dynamic_cast<IdExp*>(idx);
+        bool saveBase = am.base == "%rcx" && !leaf;
+        if (saveBase) out << " pushq %rcx" << endl;
+        idx->accept(this);
+        if (saveBase) out << " popq %rcx" << endl;
+
+        if (elemSize == 1 || elemSize == 2 || elemSize == 4 || elemSize == 8) {
+            am.scale = elemSize;
+        } else if (elemSize % 8 == 0) {
+            int m = elemSize / 8;
+            if (m == 3 || m == 5 || m == 9) {
+                out << " leaq (%rax,%rax," << (m - 1) << "), %rax" << endl;
+            } else if ((m & (m - 1)) == 0) {
+                out << " salq $" << __builtin_ctz(m) << ", %rax" << endl;
+            } else {
+                out << " imulq $" << m << ", %rax" << endl;
+            }
+            am.scale = 8;
+        } else {
+            out << " imulq $" << elemSize << ", %rax" << endl;
+            am.scale = 1;
+        }
+        am.index = "%rax";
 
         g_lastType = elemType;
         return elemType;
     }
 
-    throw runtime_error("emitLValueAddress: LHS no es un lvalue válido");
+    // cualquier otra expresión de tipo struct/array deja su dirección en %rax
+    e->accept(this);
+    am.base = "%rax";
+    return g_lastType;
 }
 
 int GenCodeVisitor::visit(StringExp* exp) {
@@ -938,22 +2474,11 @@ int GenCodeVisitor::visit(FcallStm* stm) {
 }
 
 int GenCodeVisitor::visit(ImplDec* impl) {
-    if (impl->traitName != "Add" &&
-        impl->traitName != "Sub" &&
-        impl->traitName != "Mul" &&
-        impl->traitName != "Div") {
-        return 0;
-    }
-
-    std::string opName;
-    if      (impl->traitName == "Add") opName = "add";
-    else if (impl->traitName == "Sub") opName = "sub";
-    else if (impl->traitName == "Mul") opName = "mul";
-    else if (impl->traitName == "Div") opName = "div";
+    std::string fname = opImplName(impl);
+    if (fname.empty()) return 0;
 
     // key = "Trait#LeftType#RightType"
     std::string key   = impl->traitName + "#" + impl->typeName + "#" + impl->paramType;
-    std::string fname = "__op_" + opName + "_" + impl->typeName + "_" + impl->paramType;
     g_opImplFunc[key]   = fname;
     g_opImplResult[key] = impl->returnType;
 
@@ -969,14 +2494,7 @@ int GenCodeVisitor::visit(ImplDec* impl) {
     fake.tipo   = impl->returnType;
     fake.cuerpo = impl->body;
 
-    g_pointerParams["self"] = true;
-    g_pointerParams[impl->paramName] = true;
-
     visit(&fake);
-
-    g_pointerParams.erase("self");
-    g_pointerParams.erase(impl->paramName);
-
     return 0;
 }
 
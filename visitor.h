@@ -1,10 +1,15 @@
 #ifndef VISITOR_H
 #define VISITOR_H
 #include "ast.h"
+#include "loopopt.h"
+#include "isel.h"
+#include "layout.h"
 #include <list>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
+#include <sstream>
 using namespace std;
 
 class BinaryExp;
@@ -13,6 +18,7 @@ class Program;
 
 class PrintStm;
 class WhileStm;
+class MatchStm;
 class IfStm;
 class AssignStm;
 class LetStm;
@@ -33,6 +39,7 @@ public:
     virtual int visit(PrintStm* stm) = 0;
     virtual int visit(WhileStm* stm) = 0;
     virtual int visit(IfStm* stm) = 0;
+    virtual int visit(MatchStm* stm) = 0;
     virtual int visit(AssignStm* stm) = 0;
     virtual int visit(LetStm* stm) = 0;
     virtual int visit(Body* body) = 0;
@@ -52,6 +59,7 @@ public:
 
     virtual int visit(IndexExp* ) = 0;
     virtual int visit(StringExp* exp) = 0;
+    virtual int visit(CastExp* exp) = 0;
 
 };
 
@@ -59,8 +67,9 @@ public:
 class GenCodeVisitor : public Visitor {
 private:
     std::ostream& out;
+    InstructionSelector isel;
 public:
-    GenCodeVisitor(std::ostream& out) : out(out) {}
+    GenCodeVisitor(std::ostream& out) : out(out), isel(*this, out) {}
     int generar(Program* program);
     unordered_map<string, int> memoria;
     unordered_map<string, bool> memoriaGlobal;
@@ -68,6 +77,7 @@ public:
     
     int offset = -8;
     int labelcont = 0;
+    bool usesSimd = false;   // algún bucle vectorizado necesita __rc_detect_simd
     bool entornoFuncion = false;
     bool structLet = false;
     bool structVar = false;
@@ -75,7 +85,29 @@ public:
     string nombreFuncion;
 
     std::string currentFunctionReturnType = "void";  
-    int retornoOffset = 0; 
+    int retornoOffset = 0;   // slot con el destino del resultado (struct/array), o 0
+
+    // Resultados struct/array (sret): quien llama pasa en %rdi la dirección donde
+    // el callee escribe el resultado, y los argumentos empiezan en %rsi. El destino
+    // es la variable del let/asignación si se puede; si no, un temporal en el frame
+    // que se libera al terminar la sentencia.
+    string sretLea;          // instrucción que deja el destino en %rdi, o "" (temporal)
+    int tempBase = 0;        // temporales debajo de los locales
+    int tempUsed = 0;        // bytes en uso en la sentencia actual
+    int tempMax = 0;
+    bool producesAggregate(Exp* e);
+    bool passesAggregate(Exp* e);
+    bool emitResultInto(Exp* e, const string& lea);
+    string resultDest(int bytes);
+    int tempSlot(int bytes);
+
+    // parámetros struct/array según classifyParams (layout.h): por valor en
+    // registros se guardan en el frame; por referencia, el slot tiene la dirección
+    unordered_map<string, vector<string>> funcParamTypes;
+    unordered_set<string> pointerParams;      // de la función actual
+    void emitCallArgs(const vector<Exp*>& args, const vector<string>& types, int firstReg);
+    void emitArgAddress(Exp* a, const string& t, bool byRef = false);
+    bool inStatic(Exp* e);
 
     unordered_map<string, string> funcReturnTypes;  
 
@@ -84,6 +116,39 @@ public:
     }
     int getStructSize(string structName); // Helper
 
+    // reducción de fuerza: a[iv] dentro de un bucle pasa a ser un puntero en el frame
+    struct IVPlan {
+        InductionLoop loop;
+        vector<int> ptrSlots;      // slot con &a[iv] para cada array
+        vector<int> elemSizes;
+        bool lftr = false;         // iv eliminada: la condición compara punteros
+        int endSlot = 0;           // &a0[bound] cuando lftr
+    };
+    unordered_map<WhileStm*, IVPlan> ivPlans;
+    unordered_map<string, int> ivPointers;                  // "a#iv" -> slot de &a[iv]
+    unordered_map<string, vector<pair<int,int>>> ivBumps;   // iv -> (slot, tamaño elemento)
+    unordered_set<string> ivEliminated;
+
+    // llamadas en cola: return(f(...)) reutiliza el frame actual
+    FunDec* funActual = nullptr;
+    bool tailSelf = false;          // hay saltos a .tail_<f> (recursión convertida en bucle)
+    BinaryOp accOp = PLUS_OP;       // return(e op f(...)) acumula en accSlot
+    int accSlot = 0;                // 0 si la función no usa acumulador
+
+    // modo de direccionamiento x86: disp(base,index,scale) o sym+disp(%rip)
+    struct AddrMode {
+        string base;         // "%rbp", "%rax", "%rcx" o "" si es un global
+        string sym;          // símbolo global (relativo a %rip)
+        int disp = 0;
+        string index;        // "" o "%rax"
+        int scale = 1;
+
+        string str() const;
+        bool usesRegs() const { return !index.empty() || (sym.empty() && base != "%rbp"); }
+    };
+    string selectAddress(Exp* e, AddrMode& am);
+    void emitAddress(const AddrMode& am, const string& reg);
+
     int visit(BinaryExp* exp) override;
     int visit(NumberExp* exp) override;
     int visit(IdExp* exp) override;
@@ -92,6 +157,7 @@ public:
     int visit(AssignStm* stm) override;
     int visit(WhileStm* stm) override;
     int visit(IfStm* stm) override;
+    int visit(MatchStm* stm) override;
     int visit(LetStm* stm) override;
     int visit(Body* body) override;
     int visit(VarDec* vd) override;
@@ -106,26 +172,75 @@ public:
     int visit(StructField* ) override;
     int visit(StructDec* ) override;
     int visit(StringExp* ) override;
+    int visit(CastExp* exp) override;
     int visit(FcallStm* ) override;
     int visit(ImplDec* ) override;
 
     int visit(IndexExp* exp) override;
 
-    int getTypeSize(const string& t);
-    string emitLValueAddress(Exp* lhs);
-
-};
-
-
-struct StructInfo {
-    vector<string> fieldOrder;
-    unordered_map<string,int> fieldOffset;
-    unordered_map<string,string> fieldType;
+    int getTypeSize(const string& t);          // slot en el frame (múltiplo de 8)
+
+    // campos y elementos ocupan typeSize(t) bytes; las variables, un slot de 8
+    string dataType = "i64";                    // tipo del valor que se emite en .data
+    void emitLoad(const string& t, const string& src);
+    void emitStore(const string& t, const string& dst);
+    void emitNarrow(const string& t);
+    void emitBlockCopy(int bytes);              // %rdi <- %rsi, solo pisa %rax
+    void emitCopyChunks(int from, int bytes);
+    int copyUnrollMaxBytes = 128;               // hasta aquí, movdqu desenrollados
+    int copyVectorMaxBytes = 2048;              // hasta aquí, bucle AVX/SSE; más, rep movsb
+    void emitData(const string& t, Exp* e, bool constOnly = false);
+    void emitInit(const string& t, Exp* e, const AddrMode& dst, bool dynamicOnly = false);
+
+    // literales grandes: imagen en .rodata copiada de una vez, o relleno de ceros
+    int bulkInitMinBytes  = 64;
+    int zeroStoreMaxBytes = 256;                // hasta aquí, movups; más, rep stosq
+    std::stringstream rodata;                   // imágenes, se emiten al final
+    unordered_map<string, string> rodataImages; // contenido -> etiqueta
+    void emitBulkInit(const string& t, Exp* e, const AddrMode& dst);
+    bool initReadsDest(Exp* e, const AddrMode& dst, int size);
+    void emitZeroFill(int bytes, const AddrMode& dst);
+    void emitVectorLoop(const ElementwiseLoop& ew);
+    void planInductionLoops(Body* b, Body* fnBody);
+    void emitInductionLoop(WhileStm* stm, IVPlan& plan);
+    bool ivPointerSlot(IndexExp* exp, int& slot);
+    void planTailCalls(FunDec* f);
+    bool emitTailCall(ReturnStm* stm);
+    void emitSelfJump(FcallExp* call);
+    bool emitFastPath(FunDec* f, string& code);
+    // slots del frame compartidos entre locales que no están vivos a la vez
+    unordered_set<LetStm*> deferredLets;        // se inicializan antes de su primer uso
+    vector<vector<LetStm*>> letsBefore;         // índice de sentencia -> let a inicializar
+    int assignLetSlots(Body* b);
+
+    // expresiones: orden de Sethi-Ullman y operandos directos
+    int tempsInUse = 0;             // registros temporales (%r10, %r11) ocupados
+    bool fixedAddress(Exp* e);
+    bool directOperand(Exp* e, string& opnd);
+    int regNeed(Exp* e, bool isLeft);
+    void emitArith(BinaryOp op, const string& src, bool swapped = false);
+    void emitBinary(BinaryExp* exp);
+
+    // match: despacho por tabla de saltos, prueba de bits o búsqueda binaria
+    struct MatchCase {
+        long long lo, hi;          // intervalo de valores
+        int arm;                   // brazo destino
+    };
+    int jumpTableMinCases   = 4;
+    int jumpTableMinDensity = 40;   // % de valores del rango con brazo propio
+    int jumpTableMaxSpan    = 512;
+    int bitTestMaxArms      = 3;    // una máscara (movabsq + btq) por brazo
+    void emitMatchSearch(const vector<MatchCase>& cases, size_t l, size_t r, const string& pfx);
+
+    // if-conversion: diamantes/triángulos de una asignación -> cmov
+    int ifConvertMaxCost = 6;       // nodos máximos sumando los dos brazos
+    int speculationCost(Exp* e);
+    bool emitIfConversion(IfStm* stm);
+    void emitSimdRuntime();
 
-    int totalSize = 0;  // tamaño en bytes del struct completo
 };
 
 
-extern unordered_map<string, StructInfo> structTable; // Extern declaration
+bool callFree(Exp* e);   // la expresión no contiene llamadas (ni operadores sobrecargados)
 
 #endif // VISITOR_H
\ No newline at end of file